@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <io.h>
+
+#include "AssetPack.h"
+
+// Every file below directory, with the directory as given in front, e.g. "res/shaders/Basic.shader"
+static void CollectFiles(const std::string& directory, std::vector<std::string>& filePaths)
+{
+	_finddata_t data;
+	const intptr_t handle = _findfirst((directory + "/*").c_str(), &data);
+	if (handle == -1)
+	{
+		return;
+	}
+	do
+	{
+		const std::string name = data.name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		const std::string path = directory + "/" + name;
+		if (data.attrib & _A_SUBDIR)
+		{
+			CollectFiles(path, filePaths);
+		}
+		else
+		{
+			filePaths.push_back(path);
+		}
+	} while (_findnext(handle, &data) == 0);
+	_findclose(handle);
+}
+
+/**
+ * Packs a directory into the single file AssetPack mounts, run it from where the application runs.
+ * Usage: AssetPacker <directory> <output.pack>
+ * e.g. "AssetPacker res res.pack" in OpenGL/, which is what Application mounts by default.
+ */
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		std::cout << "Usage: AssetPacker <directory> <output.pack>" << std::endl;
+		return 1;
+	}
+
+	std::string directory = argv[1];
+	while (!directory.empty() && (directory.back() == '/' || directory.back() == '\\'))
+	{
+		directory.pop_back();
+	}
+	std::vector<std::string> filePaths;
+	CollectFiles(directory, filePaths);
+	if (filePaths.empty())
+	{
+		std::cout << "No files in '" << argv[1] << "'!" << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	if (!AssetPack::Build(filePaths, argv[2]))
+	{
+		return 1;
+	}
+	const double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Read it back the way the application will
+	if (!AssetPack::Mount(argv[2]) || !AssetPack::Verify())
+	{
+		std::cout << "'" << argv[2] << "' does not read back!" << std::endl;
+		return 1;
+	}
+	size_t contentSize = 0;
+	for (const std::string& filePath : filePaths)
+	{
+		contentSize += AssetPack::Find(filePath).Size;
+	}
+	AssetPack::Unmount();
+
+	std::cout << directory << " -> " << argv[2] << ": " << filePaths.size() << " files, " << contentSize / 1024 << " KB, " << time << " ms" << std::endl;
+	return 0;
+}
@@ -8,11 +8,11 @@ layout(location = 1) in vec2 texCoord;
 // Pass texture coordinate out to the fragment shader
 out vec2 v_texCoord;
 
-uniform mat4 u_MVP;
+#include "include/UniformBlocks.glsl"
 
 void main()
 {
-	gl_Position =  u_MVP * position;
+	gl_Position =  u_ViewProj * u_Model * position;
 	v_texCoord = texCoord;
 }	
 
@@ -31,4 +31,7 @@ void main()
 {
 	// Draw the pixel from the texture to the scene by knowing the precise location in the texture to look up
 	color = texture(u_Texture, v_texCoord);
+#ifdef USE_TINT
+	color *= u_Color;
+#endif
 }
@@ -0,0 +1,80 @@
+#shader vertex
+#version 330 core
+
+// Position vertex attribute data, already transformed to world space on the CPU
+layout(location = 0) in vec3 position;
+// Color vertex attribute data
+layout(location = 1) in vec4 color;
+// Texture coordinate vertex attribute data
+layout(location = 2) in vec2 texCoord;
+// Texture slot vertex attribute data, negative means untextured
+layout(location = 3) in float texIndex;
+// Texture array layer vertex attribute data, negative means texIndex applies
+layout(location = 4) in float texLayer;
+
+out vec4 v_color;
+out vec2 v_texCoord;
+flat out float v_texIndex;
+flat out float v_texLayer;
+
+uniform mat4 u_ViewProj;
+
+void main()
+{
+	gl_Position = u_ViewProj * vec4(position, 1.0);
+	v_color = color;
+	v_texCoord = texCoord;
+	v_texIndex = texIndex;
+	v_texLayer = texLayer;
+}
+
+#shader fragment
+#version 330 core
+
+in vec4 v_color;
+in vec2 v_texCoord;
+flat in float v_texIndex;
+flat in float v_texLayer;
+// The output color
+layout(location = 0) out vec4 color;
+
+// Must match Renderer2D::MaxTextureSlots
+uniform sampler2D u_Textures[15];
+// Bound to Renderer2D::TextureArraySlot, one array serves any number of layers
+uniform sampler2DArray u_TextureArray;
+
+// GLSL 330 only allows indexing sampler arrays with constant expressions
+vec4 SampleTexture(int index, vec2 texCoord)
+{
+	switch (index)
+	{
+	case 0: return texture(u_Textures[0], texCoord);
+	case 1: return texture(u_Textures[1], texCoord);
+	case 2: return texture(u_Textures[2], texCoord);
+	case 3: return texture(u_Textures[3], texCoord);
+	case 4: return texture(u_Textures[4], texCoord);
+	case 5: return texture(u_Textures[5], texCoord);
+	case 6: return texture(u_Textures[6], texCoord);
+	case 7: return texture(u_Textures[7], texCoord);
+	case 8: return texture(u_Textures[8], texCoord);
+	case 9: return texture(u_Textures[9], texCoord);
+	case 10: return texture(u_Textures[10], texCoord);
+	case 11: return texture(u_Textures[11], texCoord);
+	case 12: return texture(u_Textures[12], texCoord);
+	case 13: return texture(u_Textures[13], texCoord);
+	case 14: return texture(u_Textures[14], texCoord);
+	}
+	return vec4(1.0);
+}
+
+void main()
+{
+	if (v_texLayer >= 0.0)
+	{
+		color = texture(u_TextureArray, vec3(v_texCoord, v_texLayer)) * v_color;
+		return;
+	}
+
+	int index = int(v_texIndex + 0.5);
+	color = v_texIndex < 0.0 ? v_color : SampleTexture(index, v_texCoord) * v_color;
+}
@@ -0,0 +1,34 @@
+#shader vertex
+#version 330 core
+
+// Position vertex attribute data
+layout(location = 0) in vec4 position;
+// Texture coordinate vertex attribute data
+layout(location = 1) in vec2 texCoord;
+// Per-instance model matrix, a mat4 attribute occupies 4 consecutive locations(2-5)
+layout(location = 2) in mat4 instanceModel;
+// Pass texture coordinate out to the fragment shader
+out vec2 v_texCoord;
+
+uniform mat4 u_ViewProj;
+
+void main()
+{
+	gl_Position = u_ViewProj * instanceModel * position;
+	v_texCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+// Passed in texture coordinate
+in vec2 v_texCoord;
+// The output color
+layout(location = 0) out vec4 color;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+	color = texture(u_Texture, v_texCoord);
+}
@@ -0,0 +1,44 @@
+#shader vertex
+#version 330 core
+
+// Position vertex attribute data
+layout(location = 0) in vec4 position;
+// Texture coordinate vertex attribute data
+layout(location = 1) in vec2 texCoord;
+// Pass texture coordinate out to the fragment shader
+out vec2 v_texCoord;
+
+uniform mat4 u_MVP;
+
+void main()
+{
+	gl_Position = u_MVP * position;
+	v_texCoord = texCoord;
+}
+
+#shader fragment
+#version 330 core
+
+// Passed in texture coordinate
+in vec2 v_texCoord;
+// The output color, or the page id with FEEDBACK
+layout(location = 0) out vec4 color;
+
+#include "include/VirtualTexture.glsl"
+
+#ifdef SHOW_LEVELS
+// Tint per sampled level
+const vec3 c_LevelColors[4] = vec3[](vec3(1.0, 0.6, 0.6), vec3(0.6, 1.0, 0.6), vec3(0.6, 0.6, 1.0), vec3(1.0, 1.0, 0.6));
+#endif
+
+void main()
+{
+#ifdef FEEDBACK
+	color = VirtualFeedback(v_texCoord);
+#else
+	color = SampleVirtual(v_texCoord);
+#ifdef SHOW_LEVELS
+	color.rgb *= c_LevelColors[int(VirtualLevel(v_texCoord)) % 4];
+#endif
+#endif
+}
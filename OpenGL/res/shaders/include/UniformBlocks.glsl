@@ -0,0 +1,13 @@
+// Uniform blocks shared by all shaders, the names must match UniformBlockNames in UniformBuffer.h
+
+// Updated once per frame, shared by all programs
+layout(std140) uniform FrameData
+{
+	mat4 u_ViewProj;
+};
+
+// Bound to a different range of the per-object ring before each draw
+layout(std140) uniform ObjectData
+{
+	mat4 u_Model;
+};
@@ -0,0 +1,62 @@
+// Sampling of a VirtualTexture, the uniforms are set by VirtualTexture::Bind() and VirtualTexture::BeginFeedback()
+
+// Width and height of level 0, index of the last level, lod bias
+uniform vec4 u_VirtualParams;
+// Page content size, border, page size with border, page cache size, all in pixels
+uniform vec4 u_PageParams;
+
+// Size of a level in pixels, rounded down like GL mip levels
+vec2 VirtualLevelSize(float level)
+{
+	return max(floor(u_VirtualParams.xy / exp2(level)), vec2(1.0));
+}
+
+// Level a mipmapped texture of the full size would sample, only whole levels are streamed
+float VirtualLevel(vec2 texCoord)
+{
+	vec2 texel = texCoord * u_VirtualParams.xy;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + u_VirtualParams.w;
+	return clamp(floor(lod), 0.0, u_VirtualParams.z);
+}
+
+// Pixel position inside a level, kept off the far edge so it always falls into an existing page
+vec2 VirtualTexel(vec2 texCoord, float level)
+{
+	vec2 size = VirtualLevelSize(level);
+	return clamp(texCoord * size, vec2(0.0), size - 0.5);
+}
+
+#ifdef FEEDBACK
+
+// Low bytes of page x and y, their high nibbles, level + 1, see VirtualTexture::ProcessFeedback()
+vec4 VirtualFeedback(vec2 texCoord)
+{
+	float level = VirtualLevel(texCoord);
+	vec2 page = floor(VirtualTexel(texCoord, level) / u_PageParams.x);
+	vec2 high = floor(page / 256.0);
+	return vec4(mod(page, 256.0), high.x + high.y * 16.0, level + 1.0) / 255.0;
+}
+
+#else
+
+// Cache slot x, y and level of the page shown for every page, a coarser one while the page itself is not resident
+uniform sampler2D u_Indirection;
+uniform sampler2D u_PageCache;
+
+vec4 SampleVirtual(vec2 texCoord)
+{
+	float level = VirtualLevel(texCoord);
+	ivec2 page = ivec2(VirtualTexel(texCoord, level) / u_PageParams.x);
+	vec3 entry = floor(texelFetch(u_Indirection, page, int(level)).xyz * 255.0 + 0.5);
+
+	// Position inside the page which is actually resident, entry.z may be coarser than level
+	vec2 texel = VirtualTexel(texCoord, entry.z);
+	vec2 inPage = texel - floor(texel / u_PageParams.x) * u_PageParams.x;
+	vec2 cacheTexel = entry.xy * u_PageParams.z + u_PageParams.y + inPage;
+	// Explicit level 0, derivatives jump between pages which are neighbours in the image but not in the cache
+	return textureLod(u_PageCache, cacheTexel / u_PageParams.w, 0.0);
+}
+
+#endif
@@ -2,19 +2,111 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <cstring>
 
+#include "AssetPack.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "ResourceCache.h"
+#include "RenderThread.h"
+#include "Texture.h"
 
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw.h"
 #include "imgui/imgui_impl_opengl3.h"
 
+#include "stb_image/stb_image.h"
+
 #include "tests/Test.h"
 #include "tests/Test_ClearColor.h"
 #include "tests/Test_Texture2D.h"
+#include "tests/Test_BatchRendering.h"
+#include "tests/Test_Instancing.h"
+#include "tests/Test_MultiDrawIndirect.h"
+#include "tests/Test_CommandLists.h"
+#include "tests/Test_MeshPool.h"
+#include "tests/Test_UniformLookup.h"
+#include "tests/Test_AsyncTextures.h"
+#include "tests/Test_TextureAtlas.h"
+#include "tests/Test_TextureArray.h"
+#include "tests/Test_VirtualTexture.h"
+
+/**
+ * Main loop variant where GL lives on a render thread.
+ * This thread only polls events, updates the test and records frame packets, so it can run ahead of GPU submission and vsync by up to one frame.
+ */
+static void RunWithRenderThread(GLFWwindow* window, test::Test*& currentTest, test::TestMenu* testMenu)
+{
+	// Fonts texture must exist before the first ImGui::NewFrame(), create it while the context is still current here
+	ImGui_ImplOpenGL3_NewFrame();
+
+	RenderThread renderThread(window);
+
+	/* Loop until the user closes the window */
+	while (!glfwWindowShouldClose(window))
+	{
+		// Start the Dear ImGui frame
+		ImGui_ImplGlfw_NewFrame();
+		ImGui::NewFrame();
+
+		FramePacket& packet = renderThread.BeginFrame();
+		bool bWaitUntilRendered = false;
 
-int main(void)
+		if (currentTest)
+		{
+			currentTest->OnUpdate(0.f);
+			if (!currentTest->OnRecordRender(packet.Commands))
+			{
+				// Fall back to immediate rendering on the render thread, and do not touch the test until it is done
+				test::Test* test = currentTest;
+				packet.ImmediateRender = [test]() { test->OnRender(); };
+				bWaitUntilRendered = true;
+			}
+
+			ImGui::Begin("Tests");
+			if (currentTest != testMenu && ImGui::Button("<-"))
+			{
+				// The packet being built refers to the test, drop it
+				packet.Commands.Reset();
+				packet.ImmediateRender = nullptr;
+				// Earlier packets are guaranteed to be rendered before this runs
+				renderThread.ExecuteSync([&currentTest]() { delete currentTest; });
+				currentTest = testMenu;
+			}
+			if (currentTest == testMenu)
+			{
+				// Menu creates tests which create GL resources
+				renderThread.ExecuteSync([&currentTest]() { currentTest->OnImGuiRender(); });
+			}
+			else
+			{
+				currentTest->OnImGuiRender();
+			}
+			ImGui::End();
+		}
+
+		ImGui::Render();
+		renderThread.EndFrame(bWaitUntilRendered);
+
+		/* Poll for and process events */
+		glfwPollEvents();
+	}
+
+	// Destroying render thread gives the context back to this thread
+}
+
+int main(int argc, char** argv)
 {
+	// Pass "--render-thread" to run GL on a dedicated thread
+	bool bUseRenderThread = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--render-thread") == 0)
+		{
+			bUseRenderThread = true;
+		}
+	}
+
 	GLFWwindow* window;
 
 	/* Initialize the library */
@@ -49,6 +141,18 @@ int main(void)
 
 	// Print OpenGL version in current graphics driver
 	std::cout << glGetString(GL_VERSION) << std::endl;
+	// Cached on first use, which has to happen while this thread owns the context
+	Texture::GetMaxAnisotropy();
+
+	// OpenGL expects the texture pixels to start at the bottom-left(0,0), PNGs store the top row first
+	// The flag is global to stb_image, so it is set once here before any loader thread decodes
+	stbi_set_flip_vertically_on_load(1);
+
+	// Assets come from the pack if one was built, from res/ otherwise
+	if (AssetPack::Mount(AssetPack::DefaultPackPath))
+	{
+		std::cout << "Mounted asset pack '" << AssetPack::DefaultPackPath << "'" << std::endl;
+	}
 
 	{
 		Renderer renderer;
@@ -68,43 +172,64 @@ int main(void)
 		currentTest = testMenu;
 		testMenu->RegisterTest<test::Test_ClearColor>("Clear color");
 		testMenu->RegisterTest<test::Test_Texture2D>("2D Texture");
-
-		/* Loop until the user closes the window */
-		while (!glfwWindowShouldClose(window))
+		testMenu->RegisterTest<test::Test_BatchRendering>("Batch Rendering");
+		testMenu->RegisterTest<test::Test_Instancing>("Instancing");
+		testMenu->RegisterTest<test::Test_MultiDrawIndirect>("Multi-Draw Indirect");
+		testMenu->RegisterTest<test::Test_CommandLists>("Command Lists");
+		testMenu->RegisterTest<test::Test_MeshPool>("Mesh Pool");
+		testMenu->RegisterTest<test::Test_UniformLookup>("Uniform Lookup");
+		testMenu->RegisterTest<test::Test_AsyncTextures>("Async Texture Loading");
+		testMenu->RegisterTest<test::Test_TextureAtlas>("Texture Atlas");
+		testMenu->RegisterTest<test::Test_TextureArray>("Texture Array");
+		testMenu->RegisterTest<test::Test_VirtualTexture>("Virtual Texture");
+
+		if (bUseRenderThread)
+		{
+			RunWithRenderThread(window, currentTest, testMenu);
+		}
+		else
 		{
-			GLCALL(glClearColor(0.f, 0.f, 0.f, 1.f));
-			/* Render here */
-			renderer.Clear();
+			/* Loop until the user closes the window */
+			while (!glfwWindowShouldClose(window))
+			{
+				GLStateCache::ResetStats();
 
-			// Start the Dear ImGui frame
-			ImGui_ImplOpenGL3_NewFrame();
-			ImGui_ImplGlfw_NewFrame();
-			ImGui::NewFrame();
+				GLCALL(glClearColor(0.f, 0.f, 0.f, 1.f));
+				/* Render here */
+				renderer.Clear();
 
-			if (currentTest)
-			{
-				currentTest->OnUpdate(0.f);
-				currentTest->OnRender();
+				// Start the Dear ImGui frame
+				ImGui_ImplOpenGL3_NewFrame();
+				ImGui_ImplGlfw_NewFrame();
+				ImGui::NewFrame();
 
-				ImGui::Begin("Tests");
-				if (currentTest != testMenu && ImGui::Button("<-"))
+				if (currentTest)
 				{
-					delete currentTest;
-					currentTest = testMenu;
+					currentTest->OnUpdate(0.f);
+					currentTest->OnRender();
+
+					ImGui::Begin("Tests");
+					if (currentTest != testMenu && ImGui::Button("<-"))
+					{
+						delete currentTest;
+						currentTest = testMenu;
+					}
+					currentTest->OnImGuiRender();
+					ImGui::End();
 				}
-				currentTest->OnImGuiRender();
-				ImGui::End();
-			}
 
-			// Rendering
-			ImGui::Render();
-			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				// Rendering
+				ImGui::Render();
+				ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+				// ImGui changes GL state behind the cache's back
+				GLStateCache::Invalidate();
 
-			/* Swap front and back buffers */
-			glfwSwapBuffers(window);
+				/* Swap front and back buffers */
+				glfwSwapBuffers(window);
 
-			/* Poll for and process events */
-			glfwPollEvents();
+				/* Poll for and process events */
+				glfwPollEvents();
+			}
 		}
 
 		delete currentTest;
@@ -112,7 +237,10 @@ int main(void)
 		{
 			delete testMenu;
 		}
+		// Released textures and shaders are still alive in the cache
+		ResourceCache::Clear();
 	}
+	AssetPack::Unmount();
 
 	// Cleanup
 	ImGui_ImplOpenGL3_Shutdown();
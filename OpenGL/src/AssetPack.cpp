@@ -0,0 +1,341 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "stb_image/stb_image.h"
+
+const char* const AssetPack::DefaultPackPath = "res.pack";
+
+static const unsigned int PackMagic = 0x4B415041; // "APAK"
+static const unsigned int PackVersion = 1;
+
+// Layout of the file, see the class comment
+struct PackHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int EntryCount;
+	/** Bytes of all paths, stored right after the table of contents without terminators. */
+	unsigned int PathsSize;
+};
+
+struct PackEntry
+{
+	unsigned long long Offset;
+	unsigned long long Size;
+	unsigned long long Hash;
+	/** Into the path strings. */
+	unsigned int PathOffset;
+	unsigned int PathLength;
+};
+
+static_assert(sizeof(PackEntry) == 32, "Pack entries must match the file layout");
+
+// The mounted pack, Data is nullptr while none is
+static const unsigned char* s_Data = nullptr;
+static size_t s_Size = 0;
+static const PackEntry* s_Entries = nullptr;
+static unsigned int s_EntryCount = 0;
+static const char* s_Paths = nullptr;
+
+// Paths as they are stored: forward slashes, lower case, no leading "./"
+static std::string NormalizePath(const std::string& filePath)
+{
+	std::string path = filePath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	std::transform(path.begin(), path.end(), path.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+	while (path.compare(0, 2, "./") == 0)
+	{
+		path.erase(0, 2);
+	}
+	return path;
+}
+
+static unsigned long long AlignOffset(unsigned long long offset)
+{
+	return (offset + AssetPack::BlobAlignment - 1) / AssetPack::BlobAlignment * AssetPack::BlobAlignment;
+}
+
+static bool ReadFile(const std::string& filePath, std::vector<unsigned char>& data)
+{
+	std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+	if (!stream)
+	{
+		return false;
+	}
+	data.resize((size_t)stream.tellg());
+	stream.seekg(0);
+	return data.empty() || (bool)stream.read((char*)data.data(), data.size());
+}
+
+bool AssetPack::Build(const std::vector<std::string>& filePaths, const std::string& packPath)
+{
+	struct Source
+	{
+		std::string Path;
+		std::string FilePath;
+	};
+	std::vector<Source> sources;
+	for (const std::string& filePath : filePaths)
+	{
+		sources.push_back({ NormalizePath(filePath), filePath });
+	}
+	// Sorted, so lookups are a binary search over the mapped table
+	std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.Path < b.Path; });
+
+	PackHeader header = { PackMagic, PackVersion, (unsigned int)sources.size(), 0 };
+	std::vector<PackEntry> entries(sources.size());
+	std::string paths;
+	for (unsigned int i = 0; i < sources.size(); ++i)
+	{
+		if (i > 0 && sources[i].Path == sources[i - 1].Path)
+		{
+			std::cout << "'" << sources[i].FilePath << "' is listed twice!" << std::endl;
+			return false;
+		}
+		entries[i].PathOffset = (unsigned int)paths.size();
+		entries[i].PathLength = (unsigned int)sources[i].Path.size();
+		paths += sources[i].Path;
+	}
+	header.PathsSize = (unsigned int)paths.size();
+
+	std::ofstream stream(packPath, std::ios::binary | std::ios::trunc);
+	stream.write((const char*)&header, sizeof(header));
+	// Written again once the offsets are known
+	stream.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+	stream.write(paths.data(), paths.size());
+
+	// Contents of identical files are stored once, found by hash and confirmed by comparing
+	std::unordered_multimap<unsigned long long, unsigned int> stored;
+	std::vector<unsigned char> data, other;
+	unsigned long long offset = sizeof(header) + entries.size() * sizeof(PackEntry) + paths.size();
+	for (unsigned int i = 0; i < sources.size(); ++i)
+	{
+		if (!ReadFile(sources[i].FilePath, data))
+		{
+			std::cout << "Failed to read '" << sources[i].FilePath << "'!" << std::endl;
+			return false;
+		}
+		PackEntry& entry = entries[i];
+		entry.Size = data.size();
+		entry.Hash = Hash(data.data(), data.size());
+
+		bool bDuplicate = false;
+		auto range = stored.equal_range(entry.Hash);
+		for (auto it = range.first; it != range.second && !bDuplicate; ++it)
+		{
+			const PackEntry& candidate = entries[it->second];
+			if (candidate.Size == entry.Size && ReadFile(sources[it->second].FilePath, other) && other == data)
+			{
+				entry.Offset = candidate.Offset;
+				bDuplicate = true;
+			}
+		}
+		if (bDuplicate)
+		{
+			continue;
+		}
+
+		const unsigned long long aligned = AlignOffset(offset);
+		const char padding[BlobAlignment] = {};
+		stream.write(padding, aligned - offset);
+		stream.write((const char*)data.data(), data.size());
+		entry.Offset = aligned;
+		offset = aligned + data.size();
+		stored.insert(std::make_pair(entry.Hash, i));
+	}
+
+	stream.seekp(sizeof(header));
+	stream.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+	if (!stream)
+	{
+		std::cout << "Failed to write '" << packPath << "'!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool AssetPack::Mount(const std::string& packPath)
+{
+	Unmount();
+
+	const void* view = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(packPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	if (mapping)
+	{
+		size = (size_t)fileSize.QuadPart;
+		view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		// The view keeps the mapping alive on its own
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+#else
+	const int file = open(packPath.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+	{
+		size = (size_t)status.st_size;
+		view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (view == MAP_FAILED)
+		{
+			view = nullptr;
+		}
+	}
+	close(file);
+#endif
+	if (!view)
+	{
+		std::cout << "Failed to map '" << packPath << "'!" << std::endl;
+		return false;
+	}
+
+	s_Data = (const unsigned char*)view;
+	s_Size = size;
+
+	// Everything is checked once here, so lookups can trust the table
+	const PackHeader* header = (const PackHeader*)s_Data;
+	bool bValid = size >= sizeof(PackHeader) && header->Magic == PackMagic && header->Version == PackVersion
+		&& size >= sizeof(PackHeader) + (unsigned long long)header->EntryCount * sizeof(PackEntry) + header->PathsSize;
+	if (bValid)
+	{
+		s_Entries = (const PackEntry*)(s_Data + sizeof(PackHeader));
+		s_EntryCount = header->EntryCount;
+		s_Paths = (const char*)(s_Entries + s_EntryCount);
+		for (unsigned int i = 0; i < s_EntryCount && bValid; ++i)
+		{
+			const PackEntry& entry = s_Entries[i];
+			bValid = entry.Offset <= size && entry.Size <= size - entry.Offset && (unsigned long long)entry.PathOffset + entry.PathLength <= header->PathsSize;
+		}
+	}
+	if (!bValid)
+	{
+		std::cout << "'" << packPath << "' is not a valid asset pack(version " << PackVersion << ")!" << std::endl;
+		Unmount();
+		return false;
+	}
+	return true;
+}
+
+void AssetPack::Unmount()
+{
+	if (!s_Data)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(s_Data);
+#else
+	munmap((void*)s_Data, s_Size);
+#endif
+	s_Data = nullptr;
+	s_Size = 0;
+	s_Entries = nullptr;
+	s_EntryCount = 0;
+	s_Paths = nullptr;
+}
+
+bool AssetPack::IsMounted()
+{
+	return s_Data != nullptr;
+}
+
+AssetView AssetPack::Find(const std::string& filePath)
+{
+	AssetView asset;
+	if (!s_Data)
+	{
+		return asset;
+	}
+
+	const std::string path = NormalizePath(filePath);
+	const PackEntry* end = s_Entries + s_EntryCount;
+	const PackEntry* entry = std::lower_bound(s_Entries, end, path, [](const PackEntry& entry, const std::string& path)
+	{
+		return path.compare(0, path.size(), s_Paths + entry.PathOffset, entry.PathLength) > 0;
+	});
+	if (entry != end && path.compare(0, path.size(), s_Paths + entry->PathOffset, entry->PathLength) == 0)
+	{
+		asset.Data = s_Data + entry->Offset;
+		asset.Size = (size_t)entry->Size;
+	}
+	return asset;
+}
+
+AssetView AssetPack::Read(const std::string& filePath, std::vector<unsigned char>& storage)
+{
+	AssetView asset = Find(filePath);
+	if (!asset.Data && ReadFile(filePath, storage))
+	{
+		// Never nullptr for a file which exists, even an empty one
+		static const unsigned char s_Empty = 0;
+		asset.Data = storage.empty() ? &s_Empty : storage.data();
+		asset.Size = storage.size();
+	}
+	return asset;
+}
+
+unsigned char* AssetPack::DecodeImage(const std::string& filePath, int& width, int& height, int& bpp)
+{
+	const AssetView asset = Find(filePath);
+	if (asset.Data)
+	{
+		return stbi_load_from_memory(asset.Data, (int)asset.Size, &width, &height, &bpp, 4/*RGBA*/);
+	}
+	return stbi_load(filePath.c_str(), &width, &height, &bpp, 4/*RGBA*/);
+}
+
+bool AssetPack::Verify()
+{
+	bool bValid = true;
+	for (unsigned int i = 0; i < s_EntryCount; ++i)
+	{
+		const PackEntry& entry = s_Entries[i];
+		if (Hash(s_Data + entry.Offset, (size_t)entry.Size) != entry.Hash)
+		{
+			std::cout << "Asset '" << std::string(s_Paths + entry.PathOffset, entry.PathLength) << "' does not match its hash!" << std::endl;
+			bValid = false;
+		}
+	}
+	return bValid;
+}
+
+unsigned long long AssetPack::Hash(const unsigned char* data, size_t size)
+{
+	// 64-bit FNV-1a
+	unsigned long long hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
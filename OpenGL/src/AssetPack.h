@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** Contents of a file, either inside the mapped pack or in the storage the caller passed in. */
+struct AssetView
+{
+	const unsigned char* Data = nullptr;
+	size_t Size = 0;
+};
+
+/**
+ * Single file archive of the res/ directory, memory-mapped so assets are read straight from the mapping without opening files.
+ * Layout: header, table of contents sorted by path, path strings, then the file contents each aligned to BlobAlignment.
+ * Every entry carries an FNV-1a hash of its contents, identical files are stored once.
+ * Paths are stored like the loaders spell them, relative to the working directory with forward slashes, e.g. "res/shaders/Basic.shader", and compared case-insensitively.
+ * Files missing from the pack, or everything while no pack is mounted, are read from disk as before.
+ * Lookups may happen on any thread, mounting and unmounting only while no asset is being loaded.
+ */
+class AssetPack
+{
+public:
+	static const unsigned int BlobAlignment = 64;
+	/** Mounted by Application if it exists, built with the AssetPacker tool. */
+	static const char* const DefaultPackPath;
+
+public:
+	/** Write a pack of the given files, each is stored under the path it was read from. */
+	static bool Build(const std::vector<std::string>& filePaths, const std::string& packPath);
+
+	/** Map a pack, replacing the one mounted before. Returns false without a message if the file does not exist. */
+	static bool Mount(const std::string& packPath);
+	/** Unmap the pack, every AssetView into it becomes invalid. */
+	static void Unmount();
+	static bool IsMounted();
+
+	/** The file inside the mounted pack, Data is nullptr if it is not in there. Valid until Unmount(). */
+	static AssetView Find(const std::string& filePath);
+	/** The file from the pack without copying, or read from disk into storage. Data is nullptr if neither has it. */
+	static AssetView Read(const std::string& filePath, std::vector<unsigned char>& storage);
+	/**
+	 * Decode an image with stb_image into RGBA8. Free the result with stbi_image_free().
+	 * Rows are flipped only if the program enabled stbi_set_flip_vertically_on_load() once at startup, the flag is global and not safe to write while workers decode.
+	 */
+	static unsigned char* DecodeImage(const std::string& filePath, int& width, int& height, int& bpp);
+
+	/** Recompute the hash of every entry, false if any does not match. Reads the whole pack. */
+	static bool Verify();
+
+	static unsigned long long Hash(const unsigned char* data, size_t size);
+
+};
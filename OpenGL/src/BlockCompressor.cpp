@@ -0,0 +1,264 @@
+#include "BlockCompressor.h"
+
+#include <algorithm>
+#include <cstring>
+
+// SSE2 is part of every x64 CPU, so no runtime dispatch is needed
+#include <emmintrin.h>
+
+// Only the format enums are needed
+#include <GL/glew.h>
+
+#include "MipmapGenerator.h"
+
+// Copy a 4x4 block, replicating the last row and column where the image ends inside the block
+static void LoadBlock(const unsigned char* pixels, int width, int height, int blockX, int blockY, unsigned char block[64])
+{
+	for (int y = 0; y < 4; ++y)
+	{
+		const int sourceY = std::min(blockY * 4 + y, height - 1);
+		for (int x = 0; x < 4; ++x)
+		{
+			const int sourceX = std::min(blockX * 4 + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, pixels + ((size_t)sourceY * width + sourceX) * 4, 4);
+		}
+	}
+}
+
+// Per channel minimum and maximum over the 16 pixels
+static void GetBlockBounds(const unsigned char block[64], unsigned char minColor[4], unsigned char maxColor[4])
+{
+	__m128i minimum = _mm_loadu_si128((const __m128i*)block);
+	__m128i maximum = minimum;
+	for (int i = 1; i < 4; ++i)
+	{
+		const __m128i row = _mm_loadu_si128((const __m128i*)(block + i * 16));
+		minimum = _mm_min_epu8(minimum, row);
+		maximum = _mm_max_epu8(maximum, row);
+	}
+	// Fold the four pixels of each register onto the first one
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 8));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 8));
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 4));
+
+	const int minPacked = _mm_cvtsi128_si32(minimum);
+	const int maxPacked = _mm_cvtsi128_si32(maximum);
+	memcpy(minColor, &minPacked, 4);
+	memcpy(maxColor, &maxPacked, 4);
+}
+
+// Dot product of every pixel's RGB with direction, the alpha of direction must be 0
+static void GetDotProducts(const unsigned char block[64], const short direction[4], int dots[16])
+{
+	const __m128i zero = _mm_setzero_si128();
+	// Two pixels per register, so the direction is repeated
+	const __m128i axis = _mm_setr_epi16(direction[0], direction[1], direction[2], 0, direction[0], direction[1], direction[2], 0);
+	for (int i = 0; i < 4; ++i)
+	{
+		const __m128i row = _mm_loadu_si128((const __m128i*)(block + i * 16));
+		// Each 32-bit lane holds r*dr+g*dg or b*db, neighbouring lanes belong to one pixel
+		const __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(row, zero), axis);
+		const __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(row, zero), axis);
+		int partial[8];
+		_mm_storeu_si128((__m128i*)partial, low);
+		_mm_storeu_si128((__m128i*)(partial + 4), high);
+		for (int p = 0; p < 4; ++p)
+		{
+			dots[i * 4 + p] = partial[p * 2] + partial[p * 2 + 1];
+		}
+	}
+}
+
+static unsigned short ToRGB565(const unsigned char color[4])
+{
+	return (unsigned short)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 | ((color[2] * 31 + 127) / 255));
+}
+
+static void FromRGB565(unsigned short packed, unsigned char color[4])
+{
+	const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (unsigned char)((r << 3) | (r >> 2));
+	color[1] = (unsigned char)((g << 2) | (g >> 4));
+	color[2] = (unsigned char)((b << 3) | (b >> 2));
+	color[3] = 255;
+}
+
+static void CompressColorBlock(const unsigned char block[64], unsigned char* dst)
+{
+	unsigned char minColor[4], maxColor[4];
+	GetBlockBounds(block, minColor, maxColor);
+	// Pulling the endpoints in by 1/16 of the range lowers the error of the interpolated colors
+	for (int c = 0; c < 3; ++c)
+	{
+		const int inset = (maxColor[c] - minColor[c]) >> 4;
+		minColor[c] = (unsigned char)(minColor[c] + inset);
+		maxColor[c] = (unsigned char)(maxColor[c] - inset);
+	}
+
+	// The box has four diagonals, flip the channels which fall while the widest one rises
+	int reference = 0;
+	for (int c = 1; c < 3; ++c)
+	{
+		if (maxColor[c] - minColor[c] > maxColor[reference] - minColor[reference])
+		{
+			reference = c;
+		}
+	}
+	int sum[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			sum[c] += block[i * 4 + c];
+		}
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		if (c == reference)
+		{
+			continue;
+		}
+		int covariance = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			covariance += (block[i * 4 + reference] * 16 - sum[reference]) * (block[i * 4 + c] * 16 - sum[c]);
+		}
+		if (covariance < 0)
+		{
+			std::swap(minColor[c], maxColor[c]);
+		}
+	}
+
+	unsigned short color0 = ToRGB565(maxColor);
+	unsigned short color1 = ToRGB565(minColor);
+	unsigned int indices = 0;
+	if (color0 < color1)
+	{
+		// The four color mode requires color0 > color1
+		std::swap(color0, color1);
+	}
+	if (color0 != color1)
+	{
+		// Project every pixel onto the line between the quantized endpoints
+		unsigned char endpoint0[4], endpoint1[4];
+		FromRGB565(color0, endpoint0);
+		FromRGB565(color1, endpoint1);
+		const short direction[4] = { (short)(endpoint0[0] - endpoint1[0]), (short)(endpoint0[1] - endpoint1[1]), (short)(endpoint0[2] - endpoint1[2]), 0 };
+		int dots[16];
+		GetDotProducts(block, direction, dots);
+		const int start = direction[0] * endpoint1[0] + direction[1] * endpoint1[1] + direction[2] * endpoint1[2];
+		const int range = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+		for (int i = 15; i >= 0; --i)
+		{
+			// Palette order along the line is color1, 1/3, 2/3, color0, i.e. indices 1, 3, 2, 0
+			const int t = (dots[i] - start) * 6;
+			const unsigned int index = t < range ? 1 : t < 3 * range ? 3 : t < 5 * range ? 2 : 0;
+			indices = (indices << 2) | index;
+		}
+	}
+
+	memcpy(dst, &color0, 2);
+	memcpy(dst + 2, &color1, 2);
+	memcpy(dst + 4, &indices, 4);
+}
+
+static void CompressAlphaBlock(const unsigned char block[64], unsigned char* dst)
+{
+	unsigned char alpha0 = 0, alpha1 = 255;
+	for (int i = 0; i < 16; ++i)
+	{
+		alpha0 = std::max(alpha0, block[i * 4 + 3]);
+		alpha1 = std::min(alpha1, block[i * 4 + 3]);
+	}
+
+	// alpha0 > alpha1 selects the mode with 6 interpolated values
+	unsigned long long indices = 0;
+	const int range = alpha0 - alpha1;
+	if (range > 0)
+	{
+		for (int i = 15; i >= 0; --i)
+		{
+			// Nearest of the 8 evenly spaced steps from alpha1(0) to alpha0(7)
+			const int step = ((block[i * 4 + 3] - alpha1) * 7 + range / 2) / range;
+			const unsigned int index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+			indices = (indices << 3) | index;
+		}
+	}
+
+	dst[0] = alpha0;
+	dst[1] = alpha1;
+	for (int i = 0; i < 6; ++i)
+	{
+		dst[2 + i] = (unsigned char)(indices >> (i * 8));
+	}
+}
+
+void BlockCompressor::CompressBC1(const unsigned char* pixels, int width, int height, unsigned char* dst)
+{
+	unsigned char block[64];
+	for (int blockY = 0; blockY < (height + 3) / 4; ++blockY)
+	{
+		for (int blockX = 0; blockX < (width + 3) / 4; ++blockX)
+		{
+			LoadBlock(pixels, width, height, blockX, blockY, block);
+			CompressColorBlock(block, dst);
+			dst += 8;
+		}
+	}
+}
+
+void BlockCompressor::CompressBC3(const unsigned char* pixels, int width, int height, unsigned char* dst)
+{
+	unsigned char block[64];
+	for (int blockY = 0; blockY < (height + 3) / 4; ++blockY)
+	{
+		for (int blockX = 0; blockX < (width + 3) / 4; ++blockX)
+		{
+			LoadBlock(pixels, width, height, blockX, blockY, block);
+			// The alpha block comes first
+			CompressAlphaBlock(block, dst);
+			CompressColorBlock(block, dst + 8);
+			dst += 16;
+		}
+	}
+}
+
+CompressedImage BlockCompressor::Compress(const unsigned char* pixels, int width, int height, unsigned int format, bool bMipmaps)
+{
+	CompressedImage image;
+	image.Format = format;
+	image.Width = width;
+	image.Height = height;
+
+	std::vector<unsigned char> chain;
+	if (bMipmaps)
+	{
+		chain = MipmapGenerator::BuildChain(pixels, width, height);
+		pixels = chain.data();
+	}
+
+	const unsigned int levelCount = bMipmaps ? MipmapGenerator::GetLevelCount(width, height) : 1;
+	for (unsigned int level = 0; level < levelCount; ++level)
+	{
+		const unsigned int offset = (unsigned int)image.Data.size();
+		const unsigned int size = DDSFile::GetLevelSize(format, width, height);
+		image.Levels.push_back({ width, height, offset, size });
+		image.Data.resize(offset + size);
+
+		if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+		{
+			CompressBC3(pixels, width, height, image.Data.data() + offset);
+		}
+		else
+		{
+			CompressBC1(pixels, width, height, image.Data.data() + offset);
+		}
+
+		pixels += (size_t)width * height * 4;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return image;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "DDSFile.h"
+
+/**
+ * Encoder for BC1(DXT1) and BC3(DXT5) from tightly packed RGBA8 images.
+ * Endpoints are fit to the inset bounding box of each block, along the diagonal matching how the channels correlate.
+ * That is fast and close to what exhaustive encoders reach on most content.
+ * Pure computation without GL, meant for cooking assets offline(see TextureCompressor).
+ */
+class BlockCompressor
+{
+public:
+	/** Alpha is dropped, use BC3 for images with transparency. */
+	static void CompressBC1(const unsigned char* pixels, int width, int height, unsigned char* dst);
+	static void CompressBC3(const unsigned char* pixels, int width, int height, unsigned char* dst);
+
+	/**
+	 * Compress an image and its mip chain(see MipmapGenerator) into one of the formats above.
+	 * @param format - GL_COMPRESSED_RGBA_S3TC_DXT1_EXT or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT.
+	 */
+	static CompressedImage Compress(const unsigned char* pixels, int width, int height, unsigned int format, bool bMipmaps);
+
+};
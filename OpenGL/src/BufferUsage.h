@@ -0,0 +1,27 @@
+#pragma once
+
+#include <GL/glew.h>
+
+/** How often the contents of a buffer are expected to change, the driver uses it to choose where the data store lives. */
+enum class BufferUsage
+{
+	/** Specified once, drawn many times. */
+	Static,
+	/** Modified repeatedly, drawn many times. */
+	Dynamic,
+	/** Respecified every frame, drawn a few times. */
+	Stream
+};
+
+inline unsigned int GetGLBufferUsage(BufferUsage usage)
+{
+	switch (usage)
+	{
+	case BufferUsage::Dynamic:
+		return GL_DYNAMIC_DRAW;
+	case BufferUsage::Stream:
+		return GL_STREAM_DRAW;
+	default:
+		return GL_STATIC_DRAW;
+	}
+}
@@ -0,0 +1,299 @@
+#include "CommandList.h"
+
+#include <cstring>
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformRing.h"
+
+enum class CommandType : unsigned char
+{
+	Clear,
+	BindPipeline,
+	BindTexture,
+	SetUniform1i,
+	SetUniform4f,
+	SetUniformMat4f,
+	SetUniformBlock,
+	DrawIndexed,
+	DrawInstanced
+};
+
+// Every command starts with this header so that the list can be walked without knowing the command types in advance
+struct CommandHeader
+{
+	CommandType Type;
+	unsigned int Size;
+};
+
+struct CmdClear
+{
+	static const CommandType Type = CommandType::Clear;
+	CommandHeader Header;
+	glm::vec4 Color;
+};
+
+struct CmdBindPipeline
+{
+	static const CommandType Type = CommandType::BindPipeline;
+	CommandHeader Header;
+	Shader* Program;
+	const VertexArray* VA;
+	const IndexBuffer* IB;
+};
+
+struct CmdBindTexture
+{
+	static const CommandType Type = CommandType::BindTexture;
+	CommandHeader Header;
+	const Texture* Tex;
+	unsigned int Slot;
+};
+
+struct CmdSetUniform1i
+{
+	static const CommandType Type = CommandType::SetUniform1i;
+	CommandHeader Header;
+	UniformName Name;
+	int Value;
+};
+
+struct CmdSetUniform4f
+{
+	static const CommandType Type = CommandType::SetUniform4f;
+	CommandHeader Header;
+	UniformName Name;
+	glm::vec4 Value;
+};
+
+struct CmdSetUniformMat4f
+{
+	static const CommandType Type = CommandType::SetUniformMat4f;
+	CommandHeader Header;
+	UniformName Name;
+	glm::mat4 Matrix;
+};
+
+struct CmdSetUniformBlock
+{
+	static const CommandType Type = CommandType::SetUniformBlock;
+	CommandHeader Header;
+	unsigned int Binding;
+	unsigned int DataSize;
+	// Followed by DataSize bytes of block data
+};
+
+struct CmdDrawIndexed
+{
+	static const CommandType Type = CommandType::DrawIndexed;
+	CommandHeader Header;
+	unsigned int IndexCount;
+};
+
+struct CmdDrawInstanced
+{
+	static const CommandType Type = CommandType::DrawInstanced;
+	CommandHeader Header;
+	unsigned int InstanceCount;
+};
+
+// Keep every command aligned for its widest member
+static const unsigned int s_CommandAlignment = 16;
+
+CommandList::CommandList(unsigned int initialCapacity)
+	: m_Buffer(new unsigned char[initialCapacity])
+	, m_Capacity(initialCapacity)
+	, m_Size(0)
+	, m_CommandCount(0)
+{
+}
+
+CommandList::~CommandList()
+{
+}
+
+void CommandList::Reset()
+{
+	m_Size = 0;
+	m_CommandCount = 0;
+}
+
+void CommandList::Reserve(unsigned int size)
+{
+	if (m_Size + size > m_Capacity)
+	{
+		// Commands are plain data, so growing is a simple copy
+		unsigned int newCapacity = m_Capacity * 2 > m_Size + size ? m_Capacity * 2 : m_Size + size;
+		unsigned char* newBuffer = new unsigned char[newCapacity];
+		memcpy(newBuffer, m_Buffer.get(), m_Size);
+		m_Buffer.reset(newBuffer);
+		m_Capacity = newCapacity;
+	}
+}
+
+template<typename T>
+T& CommandList::Allocate(unsigned int payloadSize)
+{
+	const unsigned int size = (sizeof(T) + payloadSize + s_CommandAlignment - 1) & ~(s_CommandAlignment - 1);
+	Reserve(size);
+
+	T* command = reinterpret_cast<T*>(m_Buffer.get() + m_Size);
+	command->Header.Type = T::Type;
+	command->Header.Size = size;
+	m_Size += size;
+	++m_CommandCount;
+	return *command;
+}
+
+void CommandList::Append(const CommandList& other)
+{
+	Reserve(other.m_Size);
+	memcpy(m_Buffer.get() + m_Size, other.m_Buffer.get(), other.m_Size);
+	m_Size += other.m_Size;
+	m_CommandCount += other.m_CommandCount;
+}
+
+void CommandList::Clear(const glm::vec4& color)
+{
+	CmdClear& command = Allocate<CmdClear>();
+	command.Color = color;
+}
+
+void CommandList::BindPipeline(Shader& shader, const VertexArray& va, const IndexBuffer& ib)
+{
+	CmdBindPipeline& command = Allocate<CmdBindPipeline>();
+	command.Program = &shader;
+	command.VA = &va;
+	command.IB = &ib;
+}
+
+void CommandList::BindTexture(const Texture& texture, unsigned int slot)
+{
+	CmdBindTexture& command = Allocate<CmdBindTexture>();
+	command.Tex = &texture;
+	command.Slot = slot;
+}
+
+void CommandList::SetUniform1i(const UniformName& name, int value)
+{
+	CmdSetUniform1i& command = Allocate<CmdSetUniform1i>();
+	command.Name = name;
+	command.Value = value;
+}
+
+void CommandList::SetUniform4f(const UniformName& name, const glm::vec4& value)
+{
+	CmdSetUniform4f& command = Allocate<CmdSetUniform4f>();
+	command.Name = name;
+	command.Value = value;
+}
+
+void CommandList::SetUniformMat4f(const UniformName& name, const glm::mat4& matrix)
+{
+	CmdSetUniformMat4f& command = Allocate<CmdSetUniformMat4f>();
+	command.Name = name;
+	command.Matrix = matrix;
+}
+
+void CommandList::SetUniformBlock(unsigned int binding, const void* data, unsigned int size)
+{
+	CmdSetUniformBlock& command = Allocate<CmdSetUniformBlock>(size);
+	command.Binding = binding;
+	command.DataSize = size;
+	memcpy(&command + 1, data, size);
+}
+
+void CommandList::DrawIndexed(unsigned int indexCount)
+{
+	CmdDrawIndexed& command = Allocate<CmdDrawIndexed>();
+	command.IndexCount = indexCount;
+}
+
+void CommandList::DrawInstanced(unsigned int instanceCount)
+{
+	CmdDrawInstanced& command = Allocate<CmdDrawInstanced>();
+	command.InstanceCount = instanceCount;
+}
+
+void CommandList::Execute(const Renderer& renderer, UniformRing* uniformRing) const
+{
+	// Pipeline state does not carry over between lists, every list must bind its own
+	const CmdBindPipeline* pipeline = nullptr;
+
+	unsigned int offset = 0;
+	while (offset < m_Size)
+	{
+		const unsigned char* data = m_Buffer.get() + offset;
+		const CommandHeader& header = *reinterpret_cast<const CommandHeader*>(data);
+		switch (header.Type)
+		{
+		case CommandType::Clear:
+		{
+			const CmdClear* command = reinterpret_cast<const CmdClear*>(data);
+			GLCALL(glClearColor(command->Color.r, command->Color.g, command->Color.b, command->Color.a));
+			renderer.Clear();
+			break;
+		}
+		case CommandType::BindPipeline:
+			pipeline = reinterpret_cast<const CmdBindPipeline*>(data);
+			pipeline->Program->Bind();
+			break;
+		case CommandType::BindTexture:
+		{
+			const CmdBindTexture* command = reinterpret_cast<const CmdBindTexture*>(data);
+			command->Tex->Bind(command->Slot);
+			break;
+		}
+		case CommandType::SetUniform1i:
+		{
+			const CmdSetUniform1i* command = reinterpret_cast<const CmdSetUniform1i*>(data);
+			ASSERT(pipeline);
+			pipeline->Program->SetUniform1i(command->Name, command->Value);
+			break;
+		}
+		case CommandType::SetUniform4f:
+		{
+			const CmdSetUniform4f* command = reinterpret_cast<const CmdSetUniform4f*>(data);
+			ASSERT(pipeline);
+			pipeline->Program->SetUniform4f(command->Name, command->Value.x, command->Value.y, command->Value.z, command->Value.w);
+			break;
+		}
+		case CommandType::SetUniformMat4f:
+		{
+			const CmdSetUniformMat4f* command = reinterpret_cast<const CmdSetUniformMat4f*>(data);
+			ASSERT(pipeline);
+			pipeline->Program->SetUniformMat4f(command->Name, command->Matrix);
+			break;
+		}
+		case CommandType::SetUniformBlock:
+		{
+			const CmdSetUniformBlock* command = reinterpret_cast<const CmdSetUniformBlock*>(data);
+			ASSERT(uniformRing);
+			uniformRing->Push(command->Binding, command + 1, command->DataSize);
+			break;
+		}
+		case CommandType::DrawIndexed:
+		{
+			const CmdDrawIndexed* command = reinterpret_cast<const CmdDrawIndexed*>(data);
+			ASSERT(pipeline);
+			const unsigned int indexCount = command->IndexCount == 0 ? pipeline->IB->GetCount() : command->IndexCount;
+			renderer.Draw(*pipeline->VA, *pipeline->IB, *pipeline->Program, indexCount);
+			break;
+		}
+		case CommandType::DrawInstanced:
+		{
+			const CmdDrawInstanced* command = reinterpret_cast<const CmdDrawInstanced*>(data);
+			ASSERT(pipeline);
+			renderer.DrawInstanced(*pipeline->VA, *pipeline->IB, *pipeline->Program, command->InstanceCount);
+			break;
+		}
+		default:
+			ASSERT(false);
+			break;
+		}
+		offset += header.Size;
+	}
+}
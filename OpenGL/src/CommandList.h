@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+
+#include "glm/glm.hpp"
+
+class Renderer;
+class VertexArray;
+class IndexBuffer;
+class Shader;
+struct UniformName;
+class Texture;
+class UniformRing;
+
+/**
+ * Pre-baked rendering commands.
+ * Recording only writes plain data into the list's own linear memory and never calls GL, so any thread can record into its own list.
+ * Execute() replays the commands and MUST be called on the thread owning the GL context.
+ * Referenced objects(and uniform name strings) must stay alive until the list has been executed.
+ */
+class CommandList
+{
+public:
+	CommandList(unsigned int initialCapacity = 64 * 1024);
+	~CommandList();
+
+	CommandList(const CommandList&) = delete;
+	CommandList& operator=(const CommandList&) = delete;
+
+	/** Forget all the recorded commands, the memory is kept for next recording. */
+	void Reset();
+
+	/** Append all the commands of another list, used to merge lists recorded on different threads. */
+	void Append(const CommandList& other);
+
+	/** Clear the color buffer with the specified color. */
+	void Clear(const glm::vec4& color);
+	/** Select the shader, vertex array and index buffer used by following commands. */
+	void BindPipeline(Shader& shader, const VertexArray& va, const IndexBuffer& ib);
+	void BindTexture(const Texture& texture, unsigned int slot = 0);
+	/** The name string is not copied, it should be a string literal, its hash is computed while recording. */
+	void SetUniform1i(const UniformName& name, int value);
+	void SetUniform4f(const UniformName& name, const glm::vec4& value);
+	void SetUniformMat4f(const UniformName& name, const glm::mat4& matrix);
+	/** Copy size bytes of uniform block data into the list, on execution they are pushed to the uniform ring and bound to binding. */
+	void SetUniformBlock(unsigned int binding, const void* data, unsigned int size);
+	/** indexCount of 0 means the whole index buffer. */
+	void DrawIndexed(unsigned int indexCount = 0);
+	void DrawInstanced(unsigned int instanceCount);
+
+	/** Replay the commands in recording order, uniformRing is only needed if SetUniformBlock() has been recorded. */
+	void Execute(const Renderer& renderer, UniformRing* uniformRing = nullptr) const;
+
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+	/** Bytes used by the recorded commands. */
+	inline unsigned int GetSize() const { return m_Size; }
+
+private:
+	/**
+	 * Reserve space for a command at the end of the linear buffer, the returned reference is valid until next allocation.
+	 * payloadSize more bytes are reserved right after the command for variable sized data.
+	 */
+	template<typename T>
+	T& Allocate(unsigned int payloadSize = 0);
+	/** Make sure size more bytes fit in the buffer. */
+	void Reserve(unsigned int size);
+
+private:
+	std::unique_ptr<unsigned char[]> m_Buffer;
+	unsigned int m_Capacity;
+	unsigned int m_Size;
+	unsigned int m_CommandCount;
+
+};
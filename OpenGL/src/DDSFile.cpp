@@ -0,0 +1,231 @@
+#include "DDSFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Only the format enums are needed
+#include <GL/glew.h>
+
+#include "AssetPack.h"
+
+static const unsigned int DDSMagic = 0x20534444; // "DDS "
+
+static unsigned int MakeFourCC(const char* code)
+{
+	return (unsigned int)code[0] | ((unsigned int)code[1] << 8) | ((unsigned int)code[2] << 16) | ((unsigned int)code[3] << 24);
+}
+
+// Layout of the on-disk headers, see the DDS programming guide
+struct DDSPixelFormat
+{
+	unsigned int Size;
+	unsigned int Flags;
+	unsigned int FourCC;
+	unsigned int RGBBitCount;
+	unsigned int BitMasks[4];
+};
+
+struct DDSHeader
+{
+	unsigned int Size;
+	unsigned int Flags;
+	unsigned int Height;
+	unsigned int Width;
+	unsigned int PitchOrLinearSize;
+	unsigned int Depth;
+	unsigned int MipMapCount;
+	unsigned int Reserved1[11];
+	DDSPixelFormat PixelFormat;
+	unsigned int Caps[4];
+	unsigned int Reserved2;
+};
+
+struct DDSHeaderDX10
+{
+	unsigned int DXGIFormat;
+	unsigned int ResourceDimension;
+	unsigned int MiscFlag;
+	unsigned int ArraySize;
+	unsigned int MiscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header must match the file layout");
+
+enum : unsigned int
+{
+	DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000,
+	DDPF_FOURCC = 0x4,
+	DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000,
+	DXGI_FORMAT_BC1_UNORM = 71, DXGI_FORMAT_BC3_UNORM = 77, DXGI_FORMAT_BC7_UNORM = 98,
+	D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3
+};
+
+bool DDSFile::Load(const std::string& filePath, CompressedImage& image)
+{
+	// Parsed in place, the file is only read from disk if the asset pack does not have it
+	std::vector<unsigned char> storage;
+	const AssetView file = AssetPack::Read(filePath, storage);
+	size_t position = 0;
+	auto read = [&file, &position](void* dst, size_t size)
+	{
+		if (!file.Data || size > file.Size - position)
+		{
+			return false;
+		}
+		memcpy(dst, file.Data + position, size);
+		position += size;
+		return true;
+	};
+
+	unsigned int magic = 0;
+	DDSHeader header;
+	if (!read(&magic, sizeof(magic)) || magic != DDSMagic || !read(&header, sizeof(header)) || header.Size != sizeof(DDSHeader))
+	{
+		std::cout << "'" << filePath << "' is not a DDS file!" << std::endl;
+		return false;
+	}
+
+	image.Format = 0;
+	if (header.PixelFormat.Flags & DDPF_FOURCC)
+	{
+		if (header.PixelFormat.FourCC == MakeFourCC("DXT1"))
+		{
+			image.Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		}
+		else if (header.PixelFormat.FourCC == MakeFourCC("DXT5"))
+		{
+			image.Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if (header.PixelFormat.FourCC == MakeFourCC("DX10"))
+		{
+			DDSHeaderDX10 headerDX10;
+			if (read(&headerDX10, sizeof(headerDX10)) && headerDX10.ResourceDimension == D3D10_RESOURCE_DIMENSION_TEXTURE2D && headerDX10.ArraySize <= 1)
+			{
+				switch (headerDX10.DXGIFormat)
+				{
+				case DXGI_FORMAT_BC1_UNORM: image.Format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+				case DXGI_FORMAT_BC3_UNORM: image.Format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+				case DXGI_FORMAT_BC7_UNORM: image.Format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+				default: break;
+				}
+			}
+		}
+	}
+	if (image.Format == 0)
+	{
+		std::cout << "'" << filePath << "' uses an unsupported DDS format!" << std::endl;
+		return false;
+	}
+
+	image.Width = (int)header.Width;
+	image.Height = (int)header.Height;
+	image.Levels.clear();
+	unsigned int offset = 0;
+	int width = image.Width, height = image.Height;
+	const unsigned int levelCount = (header.Flags & DDSD_MIPMAPCOUNT) ? std::max(1u, header.MipMapCount) : 1;
+	for (unsigned int level = 0; level < levelCount; ++level)
+	{
+		const unsigned int size = GetLevelSize(image.Format, width, height);
+		image.Levels.push_back({ width, height, offset, size });
+		offset += size;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	image.Data.resize(offset);
+	if (!read(image.Data.data(), offset))
+	{
+		std::cout << "'" << filePath << "' is truncated!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool DDSFile::Save(const std::string& filePath, const CompressedImage& image)
+{
+	DDSHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Size = sizeof(DDSHeader);
+	header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+	header.Height = image.Height;
+	header.Width = image.Width;
+	header.PitchOrLinearSize = image.Levels.empty() ? 0 : image.Levels[0].Size;
+	header.MipMapCount = (unsigned int)image.Levels.size();
+	header.PixelFormat.Size = sizeof(DDSPixelFormat);
+	header.PixelFormat.Flags = DDPF_FOURCC;
+	header.Caps[0] = DDSCAPS_TEXTURE;
+	if (image.Levels.size() > 1)
+	{
+		header.Flags |= DDSD_MIPMAPCOUNT;
+		header.Caps[0] |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+
+	// BC7 has no FourCC of its own and needs the extended header
+	DDSHeaderDX10 headerDX10 = { DXGI_FORMAT_BC7_UNORM, D3D10_RESOURCE_DIMENSION_TEXTURE2D, 0, 1, 0 };
+	switch (image.Format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		header.PixelFormat.FourCC = MakeFourCC("DXT1");
+		break;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		header.PixelFormat.FourCC = MakeFourCC("DXT5");
+		break;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		header.PixelFormat.FourCC = MakeFourCC("DX10");
+		break;
+	default:
+		std::cout << "Format " << image.Format << " can not be stored in a DDS file!" << std::endl;
+		return false;
+	}
+
+	std::ofstream stream(filePath, std::ios::binary);
+	stream.write((const char*)&DDSMagic, sizeof(DDSMagic));
+	stream.write((const char*)&header, sizeof(header));
+	if (header.PixelFormat.FourCC == MakeFourCC("DX10"))
+	{
+		stream.write((const char*)&headerDX10, sizeof(headerDX10));
+	}
+	stream.write((const char*)image.Data.data(), image.Data.size());
+	if (!stream)
+	{
+		std::cout << "Failed to write '" << filePath << "'!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+unsigned int DDSFile::GetBlockSize(unsigned int format)
+{
+	switch (format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		return 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+unsigned int DDSFile::GetLevelSize(unsigned int format, int width, int height)
+{
+	// Partial blocks at the edges still take a whole block
+	return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+bool DDSFile::IsDDSFile(const std::string& filePath)
+{
+	if (filePath.size() < 4)
+	{
+		return false;
+	}
+	std::string extension = filePath.substr(filePath.size() - 4);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+	return extension == ".dds";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/** Block-compressed image with its mip chain, as stored in a DDS file. */
+struct CompressedImage
+{
+	struct Level
+	{
+		int Width, Height;
+		/** Byte offset into Data. */
+		unsigned int Offset;
+		unsigned int Size;
+	};
+
+	/** GL internal format, e.g. GL_COMPRESSED_RGBA_S3TC_DXT5_EXT. */
+	unsigned int Format = 0;
+	int Width = 0, Height = 0;
+	std::vector<Level> Levels;
+	/** Every level, tightly packed. */
+	std::vector<unsigned char> Data;
+};
+
+/**
+ * Reading and writing of DDS files holding BC1(DXT1), BC3(DXT5) or BC7 textures.
+ * Pure file handling without GL, used by Texture and by the offline TextureCompressor.
+ * Rows are stored bottom-up, matching what Texture uploads for PNGs, so files written by other tools appear flipped.
+ */
+class DDSFile
+{
+public:
+	static bool Load(const std::string& filePath, CompressedImage& image);
+	static bool Save(const std::string& filePath, const CompressedImage& image);
+
+	/** Bytes per 4x4 block of a compressed GL format, 0 if the format is not supported. */
+	static unsigned int GetBlockSize(unsigned int format);
+	static unsigned int GetLevelSize(unsigned int format, int width, int height);
+
+	/** Whether the file name ends with ".dds", in any case. */
+	static bool IsDDSFile(const std::string& filePath);
+
+};
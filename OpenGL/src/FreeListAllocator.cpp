@@ -0,0 +1,127 @@
+#include "FreeListAllocator.h"
+
+#include "Renderer.h"
+
+FreeListAllocator::FreeListAllocator(unsigned int capacity)
+	: m_Capacity(capacity)
+	, m_UsedSize(0)
+{
+	if (capacity > 0)
+	{
+		InsertFreeBlock(0, capacity);
+	}
+}
+
+unsigned int FreeListAllocator::Allocate(unsigned int size)
+{
+	if (size == 0)
+	{
+		return InvalidOffset;
+	}
+
+	auto bestFit = m_FreeBySize.lower_bound(size);
+	if (bestFit == m_FreeBySize.end())
+	{
+		return InvalidOffset;
+	}
+	return TakeFromFreeBlock(m_FreeByOffset.find(bestFit->second), size);
+}
+
+unsigned int FreeListAllocator::AllocateBelow(unsigned int size, unsigned int limit)
+{
+	if (size == 0)
+	{
+		return InvalidOffset;
+	}
+
+	for (auto it = m_FreeByOffset.begin(); it != m_FreeByOffset.end() && it->first + size <= limit; ++it)
+	{
+		if (it->second >= size)
+		{
+			return TakeFromFreeBlock(it, size);
+		}
+	}
+	return InvalidOffset;
+}
+
+void FreeListAllocator::Free(unsigned int offset, unsigned int size)
+{
+	ASSERT(offset + size <= m_Capacity && size <= m_UsedSize);
+	m_UsedSize -= size;
+
+	// Merge with the following block
+	auto next = m_FreeByOffset.lower_bound(offset);
+	if (next != m_FreeByOffset.end() && next->first == offset + size)
+	{
+		size += next->second;
+		EraseFreeBlock(next);
+	}
+
+	// Merge with the preceding block
+	auto prev = m_FreeByOffset.lower_bound(offset);
+	if (prev != m_FreeByOffset.begin())
+	{
+		--prev;
+		ASSERT(prev->first + prev->second <= offset);
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			EraseFreeBlock(prev);
+		}
+	}
+
+	InsertFreeBlock(offset, size);
+}
+
+void FreeListAllocator::Grow(unsigned int newCapacity)
+{
+	if (newCapacity <= m_Capacity)
+	{
+		return;
+	}
+
+	unsigned int oldCapacity = m_Capacity;
+	m_Capacity = newCapacity;
+	// Treat the new tail as a freed range so it merges with a free block at the old end
+	m_UsedSize += newCapacity - oldCapacity;
+	Free(oldCapacity, newCapacity - oldCapacity);
+}
+
+unsigned int FreeListAllocator::GetLargestFreeBlock() const
+{
+	return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first;
+}
+
+void FreeListAllocator::InsertFreeBlock(unsigned int offset, unsigned int size)
+{
+	m_FreeByOffset[offset] = size;
+	m_FreeBySize.insert({ size, offset });
+}
+
+void FreeListAllocator::EraseFreeBlock(std::map<unsigned int, unsigned int>::iterator it)
+{
+	auto range = m_FreeBySize.equal_range(it->second);
+	for (auto bySize = range.first; bySize != range.second; ++bySize)
+	{
+		if (bySize->second == it->first)
+		{
+			m_FreeBySize.erase(bySize);
+			break;
+		}
+	}
+	m_FreeByOffset.erase(it);
+}
+
+unsigned int FreeListAllocator::TakeFromFreeBlock(std::map<unsigned int, unsigned int>::iterator it, unsigned int size)
+{
+	unsigned int offset = it->first;
+	unsigned int blockSize = it->second;
+	EraseFreeBlock(it);
+	if (blockSize > size)
+	{
+		InsertFreeBlock(offset + size, blockSize - size);
+	}
+	m_UsedSize += size;
+	return offset;
+}
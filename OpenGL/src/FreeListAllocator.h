@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+
+/**
+ * Hands out ranges of an abstract linear space (e.g. vertices or indices of a GPU buffer), it never touches any memory itself.
+ * Free blocks are indexed both by offset, for coalescing, and by size, for best-fit allocation.
+ */
+class FreeListAllocator
+{
+public:
+	static const unsigned int InvalidOffset = 0xFFFFFFFF;
+
+	FreeListAllocator(unsigned int capacity);
+
+	/** Return the offset of a free range of size units using the smallest block that fits, or InvalidOffset if none. */
+	unsigned int Allocate(unsigned int size);
+	/** Like Allocate() but take the lowest addressed block which can hold the whole range below limit, used to compact allocations. */
+	unsigned int AllocateBelow(unsigned int size, unsigned int limit);
+	/** Return a range to the free list, it is merged with its free neighbours. */
+	void Free(unsigned int offset, unsigned int size);
+	/** Append newCapacity - capacity free units to the end of the space. */
+	void Grow(unsigned int newCapacity);
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetUsedSize() const { return m_UsedSize; }
+	inline unsigned int GetFreeBlockCount() const { return (unsigned int)m_FreeByOffset.size(); }
+	/** Offset of the first free block, allocations above it leave a hole behind them. */
+	inline unsigned int GetLowestFreeOffset() const { return m_FreeByOffset.empty() ? m_Capacity : m_FreeByOffset.begin()->first; }
+	unsigned int GetLargestFreeBlock() const;
+
+private:
+	void InsertFreeBlock(unsigned int offset, unsigned int size);
+	void EraseFreeBlock(std::map<unsigned int, unsigned int>::iterator it);
+	/** Remove size units from the front of the given free block and return its offset. */
+	unsigned int TakeFromFreeBlock(std::map<unsigned int, unsigned int>::iterator it, unsigned int size);
+
+private:
+	unsigned int m_Capacity;
+	unsigned int m_UsedSize;
+
+	/** Offset to size. */
+	std::map<unsigned int, unsigned int> m_FreeByOffset;
+	/** Size to offset. */
+	std::multimap<unsigned int, unsigned int> m_FreeBySize;
+};
@@ -0,0 +1,224 @@
+#include "GLStateCache.h"
+
+#include <unordered_map>
+
+#include "Renderer.h"
+
+// Marks a binding whose real value is not known, the next bind to it will always be issued
+static const unsigned int s_Unknown = 0xFFFFFFFF;
+
+struct GLState
+{
+	unsigned int Program = s_Unknown;
+	unsigned int VertexArray = s_Unknown;
+	unsigned int ArrayBuffer = s_Unknown;
+	/** Element buffer binding of current vertex array. */
+	unsigned int ElementArrayBuffer = s_Unknown;
+	unsigned int ActiveTextureSlot = s_Unknown;
+	unsigned int Textures2D[GLStateCache::MaxTextureUnits];
+
+	/** Element buffer binding is part of vertex array state, so it is remembered per vertex array. */
+	std::unordered_map<unsigned int, unsigned int> VertexArrayElementBuffers;
+
+	GLState()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		Program = s_Unknown;
+		VertexArray = s_Unknown;
+		ArrayBuffer = s_Unknown;
+		ElementArrayBuffer = s_Unknown;
+		ActiveTextureSlot = s_Unknown;
+		for (unsigned int i = 0; i < GLStateCache::MaxTextureUnits; ++i)
+		{
+			Textures2D[i] = s_Unknown;
+		}
+		VertexArrayElementBuffers.clear();
+	}
+};
+
+static GLState s_State;
+static GLStateCache::Statistics s_Stats;
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+	if (s_State.Program == program)
+	{
+		++s_Stats.SkippedCalls;
+		return;
+	}
+
+	GLCALL(glUseProgram(program));
+	s_State.Program = program;
+	++s_Stats.IssuedCalls;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+	if (s_State.VertexArray == vertexArray)
+	{
+		++s_Stats.SkippedCalls;
+		return;
+	}
+
+	GLCALL(glBindVertexArray(vertexArray));
+	s_State.VertexArray = vertexArray;
+	++s_Stats.IssuedCalls;
+
+	// Binding another vertex array changes the element buffer binding as well
+	auto it = s_State.VertexArrayElementBuffers.find(vertexArray);
+	s_State.ElementArrayBuffer = it != s_State.VertexArrayElementBuffers.end() ? it->second : s_Unknown;
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	unsigned int* cached = nullptr;
+	if (target == GL_ARRAY_BUFFER)
+	{
+		cached = &s_State.ArrayBuffer;
+	}
+	else if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		cached = &s_State.ElementArrayBuffer;
+	}
+
+	if (cached && *cached == buffer)
+	{
+		++s_Stats.SkippedCalls;
+		return;
+	}
+
+	GLCALL(glBindBuffer(target, buffer));
+	++s_Stats.IssuedCalls;
+	if (cached)
+	{
+		*cached = buffer;
+	}
+	if (target == GL_ELEMENT_ARRAY_BUFFER && s_State.VertexArray != s_Unknown)
+	{
+		s_State.VertexArrayElementBuffers[s_State.VertexArray] = buffer;
+	}
+}
+
+void GLStateCache::ActiveTexture(unsigned int slot)
+{
+	if (s_State.ActiveTextureSlot == slot)
+	{
+		++s_Stats.SkippedCalls;
+		return;
+	}
+
+	// Select active texture unit(slot)
+	GLCALL(glActiveTexture(GL_TEXTURE0 + slot));
+	s_State.ActiveTextureSlot = slot;
+	++s_Stats.IssuedCalls;
+}
+
+void GLStateCache::BindTexture(unsigned int target, unsigned int slot, unsigned int texture)
+{
+	unsigned int* cached = nullptr;
+	if (target == GL_TEXTURE_2D && slot < MaxTextureUnits)
+	{
+		cached = &s_State.Textures2D[slot];
+	}
+
+	if (cached && *cached == texture)
+	{
+		++s_Stats.SkippedCalls;
+		return;
+	}
+
+	ActiveTexture(slot);
+	GLCALL(glBindTexture(target, texture));
+	++s_Stats.IssuedCalls;
+	if (cached)
+	{
+		*cached = texture;
+	}
+}
+
+unsigned int GLStateCache::GetActiveTextureSlot()
+{
+	// Unknown means nobody has selected a unit through the cache, GL_TEXTURE0 is the default
+	return s_State.ActiveTextureSlot == s_Unknown ? 0 : s_State.ActiveTextureSlot;
+}
+
+void GLStateCache::OnProgramDeleted(unsigned int program)
+{
+	// A deleted program stays in use until another one is installed, but its name should not be trusted anymore
+	if (s_State.Program == program)
+	{
+		s_State.Program = s_Unknown;
+	}
+}
+
+void GLStateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	s_State.VertexArrayElementBuffers.erase(vertexArray);
+	if (s_State.VertexArray == vertexArray)
+	{
+		// GL reverts the binding to zero
+		s_State.VertexArray = 0;
+		s_State.ElementArrayBuffer = s_Unknown;
+	}
+}
+
+void GLStateCache::OnBufferDeleted(unsigned int buffer)
+{
+	// Vertex arrays which are not bound may still refer to the name which can be reused, so forget them
+	for (auto it = s_State.VertexArrayElementBuffers.begin(); it != s_State.VertexArrayElementBuffers.end();)
+	{
+		if (it->second == buffer)
+		{
+			it = s_State.VertexArrayElementBuffers.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	// GL reverts the bindings of current context to zero
+	if (s_State.ArrayBuffer == buffer)
+	{
+		s_State.ArrayBuffer = 0;
+	}
+	if (s_State.ElementArrayBuffer == buffer)
+	{
+		s_State.ElementArrayBuffer = 0;
+		if (s_State.VertexArray != s_Unknown)
+		{
+			s_State.VertexArrayElementBuffers[s_State.VertexArray] = 0;
+		}
+	}
+}
+
+void GLStateCache::OnTextureDeleted(unsigned int texture)
+{
+	// GL reverts the bindings of all texture units to zero
+	for (unsigned int i = 0; i < MaxTextureUnits; ++i)
+	{
+		if (s_State.Textures2D[i] == texture)
+		{
+			s_State.Textures2D[i] = 0;
+		}
+	}
+}
+
+void GLStateCache::Invalidate()
+{
+	s_State.Reset();
+}
+
+const GLStateCache::Statistics& GLStateCache::GetStats()
+{
+	return s_Stats;
+}
+
+void GLStateCache::ResetStats()
+{
+	s_Stats = Statistics();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+ * Shadow copy of the GL bindings that are changed frequently while rendering.
+ * All bind calls should be routed through here so that the ones changing nothing never reach the driver.
+ * Only the thread owning the GL context may use this.
+ */
+class GLStateCache
+{
+public:
+	struct Statistics
+	{
+		/** Calls actually forwarded to GL. */
+		unsigned int IssuedCalls = 0;
+		/** Redundant calls that have been skipped. */
+		unsigned int SkippedCalls = 0;
+	};
+
+	/** Maximum texture units tracked, binds to higher units are always issued. */
+	static const unsigned int MaxTextureUnits = 32;
+
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	/** Only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are cached, other targets are always issued. */
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void ActiveTexture(unsigned int slot);
+	/** Bind the texture to the specified slot, the active texture unit will be changed to slot if necessary. */
+	static void BindTexture(unsigned int target, unsigned int slot, unsigned int texture);
+
+	static unsigned int GetActiveTextureSlot();
+
+	/** These MUST be called after deleting GL objects as GL resets the bindings and the names can be reused. */
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+	static void OnTextureDeleted(unsigned int texture);
+
+	/** Forget everything, call this after any code which changes GL state without going through the cache. */
+	static void Invalidate();
+
+	static const Statistics& GetStats();
+	static void ResetStats();
+
+};
@@ -1,34 +1,207 @@
 #include "IndexBuffer.h"
 
+#include <cstring>
+#include <vector>
+
 #include "Renderer.h"
+#include "GLStateCache.h"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
+static unsigned int GetMaxIndex(const unsigned int* data, unsigned int count)
+{
+	unsigned int maxIndex = 0;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (data[i] > maxIndex)
+		{
+			maxIndex = data[i];
+		}
+	}
+	return maxIndex;
+}
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage)
 	: m_Count(count)
+	, m_Usage(usage)
+	, m_IndexType(data && usage == BufferUsage::Static ? GetIndexTypeFor(GetMaxIndex(data, count)) : GL_UNSIGNED_INT)
+	, m_IndexSize(GetSizeOfType(m_IndexType))
+	, m_UntouchedOffset(0)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
 	// Generate index buffer object names
 	GLCALL(glCreateBuffers(1, &m_RendererID));
 	// Bind
-	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	// Create and initialize a index buffer object's data store
-	GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+	// Create a index buffer object's data store, the initial indices go through the same narrowing as later updates
+	GLCALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * m_IndexSize, m_IndexSize == sizeof(unsigned int) ? data : nullptr, GetGLBufferUsage(usage)));
 	// Unbind
-	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (data && m_IndexSize != sizeof(unsigned int))
+	{
+		GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+		Upload(0, data, count, false);
+	}
+	if (data)
+	{
+		m_UntouchedOffset = count;
+	}
+}
+
+IndexBuffer::IndexBuffer(unsigned int count, BufferUsage usage, unsigned int indexType)
+	: m_Count(count)
+	, m_Usage(usage)
+	, m_IndexType(indexType)
+	, m_IndexSize(GetSizeOfType(indexType))
+	, m_UntouchedOffset(0)
+{
+	GLCALL(glCreateBuffers(1, &m_RendererID));
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCALL(glBufferData(GL_COPY_WRITE_BUFFER, count * m_IndexSize, nullptr, GetGLBufferUsage(usage)));
 }
 
 IndexBuffer::~IndexBuffer()
 {
 	// Delete named index objects
 	GLCALL(glDeleteBuffers(1, &m_RendererID));
+	GLStateCache::OnBufferDeleted(m_RendererID);
+}
+
+unsigned int IndexBuffer::GetIndexTypeFor(unsigned int maxIndex)
+{
+	return maxIndex <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int indexType)
+{
+	switch (indexType)
+	{
+	case GL_UNSIGNED_INT:
+		return 4;
+	case GL_UNSIGNED_SHORT:
+		return 2;
+	case GL_UNSIGNED_BYTE:
+		return 1;
+	default:
+		break;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+void IndexBuffer::SetData(unsigned int offset, const unsigned int* data, unsigned int count)
+{
+	ASSERT(offset + count <= m_Count);
+
+	// Go through the copy write target so the element array binding of whatever vertex array is bound stays untouched
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	// Nothing the GPU may still read lives in an untouched range, so the implicit synchronization can be skipped
+	Upload(offset, data, count, m_Usage != BufferUsage::Static && offset >= m_UntouchedOffset);
+	if (offset + count > m_UntouchedOffset)
+	{
+		m_UntouchedOffset = offset + count;
+	}
+}
+
+void IndexBuffer::Upload(unsigned int offset, const unsigned int* data, unsigned int count, bool bUnsynchronized)
+{
+	const void* source = data;
+	std::vector<unsigned char> narrowed;
+	if (m_IndexSize != sizeof(unsigned int))
+	{
+		narrowed.resize(count * m_IndexSize);
+		if (m_IndexType == GL_UNSIGNED_SHORT)
+		{
+			unsigned short* dest = (unsigned short*)narrowed.data();
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				ASSERT(data[i] <= 0xFFFF);
+				dest[i] = (unsigned short)data[i];
+			}
+		}
+		else
+		{
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				ASSERT(data[i] <= 0xFF);
+				narrowed[i] = (unsigned char)data[i];
+			}
+		}
+		source = narrowed.data();
+	}
+
+	void* mapped = nullptr;
+	if (bUnsynchronized)
+	{
+		GLCALL(mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset * m_IndexSize, count * m_IndexSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	}
+	if (mapped)
+	{
+		memcpy(mapped, source, count * m_IndexSize);
+		GLCALL(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+	}
+	else
+	{
+		// Also the fallback if mapping failed
+		GLCALL(glBufferSubData(GL_COPY_WRITE_BUFFER, offset * m_IndexSize, count * m_IndexSize, source));
+	}
+}
+
+void IndexBuffer::Resize(unsigned int count, bool bKeepData)
+{
+	unsigned int copySize = (bKeepData ? (count < m_UntouchedOffset ? count : m_UntouchedOffset) : 0) * m_IndexSize;
+	unsigned int tempBuffer = 0;
+	if (copySize > 0)
+	{
+		// Park the old contents in a temporary buffer as reallocating discards them
+		GLCALL(glGenBuffers(1, &tempBuffer));
+		GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, tempBuffer));
+		GLCALL(glBufferData(GL_COPY_WRITE_BUFFER, copySize, nullptr, GL_STREAM_COPY));
+		GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_RendererID));
+		GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copySize));
+	}
+
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCALL(glBufferData(GL_COPY_WRITE_BUFFER, count * m_IndexSize, nullptr, GetGLBufferUsage(m_Usage)));
+	m_Count = count;
+	m_UntouchedOffset = copySize / m_IndexSize;
+
+	if (copySize > 0)
+	{
+		GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, tempBuffer));
+		GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copySize));
+		GLCALL(glDeleteBuffers(1, &tempBuffer));
+		GLStateCache::OnBufferDeleted(tempBuffer);
+	}
+}
+
+void IndexBuffer::CopySubData(unsigned int readOffset, unsigned int writeOffset, unsigned int count)
+{
+	ASSERT(readOffset + count <= writeOffset || writeOffset + count <= readOffset);
+
+	GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_RendererID));
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset * m_IndexSize, writeOffset * m_IndexSize, count * m_IndexSize));
+	if (writeOffset + count > m_UntouchedOffset)
+	{
+		m_UntouchedOffset = writeOffset + count;
+	}
+}
+
+void IndexBuffer::Orphan()
+{
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	// Same size and null data lets the driver hand out a new store while the old one is still read by the GPU
+	GLCALL(glBufferData(GL_COPY_WRITE_BUFFER, m_Count * m_IndexSize, nullptr, GetGLBufferUsage(m_Usage)));
+	m_UntouchedOffset = 0;
 }
 
 void IndexBuffer::Bind() const
 {
-	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-	GLCALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -1,21 +1,55 @@
 #pragma once
 
+#include "BufferUsage.h"
+
 class IndexBuffer
 {
 public:
-	/** Count means element count. */
-	IndexBuffer(const unsigned int* data, unsigned int count);
+	/**
+	 * Count means element count.
+	 * Static buffers are stored with the narrowest index type which can hold the largest index, the contents of other buffers may grow so they keep 32-bit indices.
+	 */
+	IndexBuffer(const unsigned int* data, unsigned int count, BufferUsage usage = BufferUsage::Static);
+	/** Create an empty index buffer holding count indices of indexType(GL_UNSIGNED_SHORT or GL_UNSIGNED_INT) to be filled via SetData(). */
+	IndexBuffer(unsigned int count, BufferUsage usage = BufferUsage::Dynamic, unsigned int indexType = GL_UNSIGNED_INT);
 	~IndexBuffer();
 
 	inline unsigned int GetCount() const { return m_Count; };
+	inline BufferUsage GetUsage() const { return m_Usage; }
+	/** Type to pass to glDrawElements*(). */
+	inline unsigned int GetIndexType() const { return m_IndexType; }
+	/** Size of one stored index in bytes, byte offsets into the buffer are index offsets times this. */
+	inline unsigned int GetIndexSize() const { return m_IndexSize; }
+
+	/** Smallest index type able to represent maxIndex, 8-bit indices are skipped as many GPUs lack native support and the driver converts them on the CPU. */
+	static unsigned int GetIndexTypeFor(unsigned int maxIndex);
+	static unsigned int GetSizeOfType(unsigned int indexType);
+
+	/** Update count indices of this index buffer's data store starting at offset(in indices), they are narrowed to the stored index type. */
+	void SetData(unsigned int offset, const unsigned int* data, unsigned int count);
+	/** Reallocate the data store to hold count indices, the name stays the same so vertex arrays referring to it remain valid. */
+	void Resize(unsigned int count, bool bKeepData = true);
+	/** Copy count indices within this buffer on the GPU, offsets are in indices and the two ranges must not overlap. */
+	void CopySubData(unsigned int readOffset, unsigned int writeOffset, unsigned int count);
+	/** Detach the data store from the GPU's pending reads and get a fresh one of the same size, the contents become undefined. */
+	void Orphan();
 
 	/** Bind a named index buffer object. */
 	void Bind() const;
 	/** Unbind index buffer objects. */
 	void Unbind() const;
 
+private:
+	/** Upload indices to the bound GL_COPY_WRITE_BUFFER, converting them to the stored index type first. */
+	void Upload(unsigned int offset, const unsigned int* data, unsigned int count, bool bUnsynchronized);
+
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	BufferUsage m_Usage;
+	unsigned int m_IndexType;
+	unsigned int m_IndexSize;
+	/** Indices from here to the end have not been written since the data store was allocated, so the GPU cannot be reading them. */
+	unsigned int m_UntouchedOffset;
 
 };
@@ -0,0 +1,60 @@
+#include "IndirectBuffer.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+IndirectBuffer::IndirectBuffer()
+	: m_RendererID(0)
+	, m_Capacity(0)
+{
+	static_assert(sizeof(DrawElementsIndirectCommand) == 5 * sizeof(GLuint), "DrawElementsIndirectCommand must be tightly packed");
+
+	GLCALL(glGenBuffers(1, &m_RendererID));
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	GLCALL(glDeleteBuffers(1, &m_RendererID));
+	GLStateCache::OnBufferDeleted(m_RendererID);
+}
+
+void IndirectBuffer::Clear()
+{
+	m_Commands.clear();
+}
+
+void IndirectBuffer::AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex, unsigned int baseInstance, unsigned int instanceCount)
+{
+	m_Commands.push_back({ indexCount, instanceCount, firstIndex, baseVertex, baseInstance });
+}
+
+void IndirectBuffer::Upload()
+{
+	// Indirect drawing is only available since GL 4.0, the CPU side copy is all we need otherwise
+	if (!GLEW_VERSION_4_0 || m_Commands.empty())
+	{
+		return;
+	}
+
+	Bind();
+	const unsigned int size = (unsigned int)(m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+	if (m_Commands.size() > m_Capacity)
+	{
+		m_Capacity = (unsigned int)m_Commands.size();
+		GLCALL(glBufferData(GL_DRAW_INDIRECT_BUFFER, size, m_Commands.data(), GL_DYNAMIC_DRAW));
+	}
+	else
+	{
+		GLCALL(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_Commands.data()));
+	}
+}
+
+void IndirectBuffer::Bind() const
+{
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+}
+
+void IndirectBuffer::Unbind() const
+{
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+/** Memory layout expected by glMultiDrawElementsIndirect, must not be changed. */
+struct DrawElementsIndirectCommand
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	/** Offset into the index buffer, in indices. */
+	unsigned int FirstIndex;
+	int BaseVertex;
+	/** Offset added to the fetch index of per-instance attributes, usable for indexing per-object data. */
+	unsigned int BaseInstance;
+};
+
+/**
+ * Draw commands of many meshes which share one vertex array and shader.
+ * Commands are collected on the CPU and uploaded to a GL_DRAW_INDIRECT_BUFFER so that they can be submitted with one call.
+ */
+class IndirectBuffer
+{
+public:
+	IndirectBuffer();
+	~IndirectBuffer();
+
+	/** Remove all the recorded commands, the GPU buffer is kept for reuse. */
+	void Clear();
+	void AddDraw(unsigned int indexCount, unsigned int firstIndex, int baseVertex, unsigned int baseInstance, unsigned int instanceCount = 1);
+	/** Send the recorded commands to the GPU, the data store grows if necessary. */
+	void Upload();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+	inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+
+	/** Bind the buffer object to GL_DRAW_INDIRECT_BUFFER. */
+	void Bind() const;
+	void Unbind() const;
+
+private:
+	unsigned int m_RendererID;
+	/** Size of the GPU data store in commands. */
+	unsigned int m_Capacity;
+
+	/** CPU side copy, also used to emulate the multi-draw on older contexts. */
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+
+};
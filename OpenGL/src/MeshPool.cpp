@@ -0,0 +1,195 @@
+#include "MeshPool.h"
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndirectBuffer.h"
+
+MeshPool::MeshPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity, unsigned int indexType)
+	: m_VertexStride(layout.GetStride())
+	, m_VertexAllocator(vertexCapacity)
+	, m_IndexAllocator(indexCapacity)
+	, m_MeshCount(0)
+{
+	m_VAO.reset(new VertexArray());
+	m_VBO.reset(new VertexBuffer(vertexCapacity * m_VertexStride, BufferUsage::Dynamic));
+	m_VAO->AddBuffer(*m_VBO, layout);
+	m_IBO.reset(new IndexBuffer(indexCapacity, BufferUsage::Dynamic, indexType));
+}
+
+MeshPool::~MeshPool()
+{
+}
+
+MeshPool::MeshHandle MeshPool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	ASSERT(vertexCount > 0 && indexCount > 0);
+
+	Mesh mesh;
+	mesh.VertexCount = vertexCount;
+	mesh.IndexCount = indexCount;
+	mesh.VertexOffset = AllocateVertices(vertexCount);
+	mesh.IndexOffset = AllocateIndices(indexCount);
+	mesh.bAlive = true;
+
+	m_VBO->SetData(mesh.VertexOffset * m_VertexStride, vertices, vertexCount * m_VertexStride);
+	m_IBO->SetData(mesh.IndexOffset, indices, indexCount);
+
+	MeshHandle handle;
+	if (!m_FreeHandles.empty())
+	{
+		handle = m_FreeHandles.back();
+		m_FreeHandles.pop_back();
+		m_Meshes[handle] = mesh;
+	}
+	else
+	{
+		handle = (MeshHandle)m_Meshes.size();
+		m_Meshes.push_back(mesh);
+	}
+	m_MeshesByVertexOffset[mesh.VertexOffset] = handle;
+	m_MeshesByIndexOffset[mesh.IndexOffset] = handle;
+	++m_MeshCount;
+	return handle;
+}
+
+void MeshPool::RemoveMesh(MeshHandle handle)
+{
+	ASSERT(handle < m_Meshes.size() && m_Meshes[handle].bAlive);
+
+	Mesh& mesh = m_Meshes[handle];
+	m_VertexAllocator.Free(mesh.VertexOffset, mesh.VertexCount);
+	m_IndexAllocator.Free(mesh.IndexOffset, mesh.IndexCount);
+	m_MeshesByVertexOffset.erase(mesh.VertexOffset);
+	m_MeshesByIndexOffset.erase(mesh.IndexOffset);
+	mesh.bAlive = false;
+	m_FreeHandles.push_back(handle);
+	--m_MeshCount;
+}
+
+MeshRange MeshPool::GetRange(MeshHandle handle) const
+{
+	ASSERT(handle < m_Meshes.size() && m_Meshes[handle].bAlive);
+
+	const Mesh& mesh = m_Meshes[handle];
+	return { mesh.IndexCount, mesh.IndexOffset, (int)mesh.VertexOffset };
+}
+
+void MeshPool::Draw(const Renderer& renderer, const Shader& shader, MeshHandle handle) const
+{
+	MeshRange range = GetRange(handle);
+	renderer.Draw(*m_VAO, *m_IBO, shader, range.IndexCount, range.BaseVertex, range.FirstIndex);
+}
+
+void MeshPool::AddDraw(IndirectBuffer& indirect, MeshHandle handle, unsigned int baseInstance, unsigned int instanceCount) const
+{
+	MeshRange range = GetRange(handle);
+	indirect.AddDraw(range.IndexCount, range.FirstIndex, range.BaseVertex, baseInstance, instanceCount);
+}
+
+unsigned int MeshPool::Defragment(unsigned int maxMoves)
+{
+	unsigned int moveCount = 0;
+
+	// Walk from the top, a mesh below the lowest hole has nowhere to go and neither has anything under it
+	for (auto it = m_MeshesByVertexOffset.rbegin(); it != m_MeshesByVertexOffset.rend() && moveCount < maxMoves;)
+	{
+		if (it->first < m_VertexAllocator.GetLowestFreeOffset())
+		{
+			break;
+		}
+		MeshHandle handle = it->second;
+		unsigned int oldOffset = it->first;
+		++it;
+		if (MoveVertices(handle))
+		{
+			++moveCount;
+			// The map changed under the iterator, carry on below the vacated range
+			it = std::map<unsigned int, MeshHandle>::reverse_iterator(m_MeshesByVertexOffset.lower_bound(oldOffset));
+		}
+	}
+
+	unsigned int indexMoveCount = 0;
+	for (auto it = m_MeshesByIndexOffset.rbegin(); it != m_MeshesByIndexOffset.rend() && indexMoveCount < maxMoves;)
+	{
+		if (it->first < m_IndexAllocator.GetLowestFreeOffset())
+		{
+			break;
+		}
+		MeshHandle handle = it->second;
+		unsigned int oldOffset = it->first;
+		++it;
+		if (MoveIndices(handle))
+		{
+			++indexMoveCount;
+			it = std::map<unsigned int, MeshHandle>::reverse_iterator(m_MeshesByIndexOffset.lower_bound(oldOffset));
+		}
+	}
+
+	return moveCount + indexMoveCount;
+}
+
+unsigned int MeshPool::AllocateVertices(unsigned int count)
+{
+	unsigned int offset = m_VertexAllocator.Allocate(count);
+	if (offset == FreeListAllocator::InvalidOffset)
+	{
+		unsigned int capacity = m_VertexAllocator.GetCapacity();
+		unsigned int newCapacity = capacity * 2 > capacity + count ? capacity * 2 : capacity + count;
+		m_VBO->Resize(newCapacity * m_VertexStride);
+		m_VertexAllocator.Grow(newCapacity);
+		offset = m_VertexAllocator.Allocate(count);
+	}
+	return offset;
+}
+
+unsigned int MeshPool::AllocateIndices(unsigned int count)
+{
+	unsigned int offset = m_IndexAllocator.Allocate(count);
+	if (offset == FreeListAllocator::InvalidOffset)
+	{
+		unsigned int capacity = m_IndexAllocator.GetCapacity();
+		unsigned int newCapacity = capacity * 2 > capacity + count ? capacity * 2 : capacity + count;
+		m_IBO->Resize(newCapacity);
+		m_IndexAllocator.Grow(newCapacity);
+		offset = m_IndexAllocator.Allocate(count);
+	}
+	return offset;
+}
+
+bool MeshPool::MoveVertices(MeshHandle handle)
+{
+	Mesh& mesh = m_Meshes[handle];
+	// The destination must end before the mesh starts, overlapping copies within one buffer are not allowed
+	unsigned int offset = m_VertexAllocator.AllocateBelow(mesh.VertexCount, mesh.VertexOffset);
+	if (offset == FreeListAllocator::InvalidOffset)
+	{
+		return false;
+	}
+
+	m_VBO->CopySubData(mesh.VertexOffset * m_VertexStride, offset * m_VertexStride, mesh.VertexCount * m_VertexStride);
+	m_VertexAllocator.Free(mesh.VertexOffset, mesh.VertexCount);
+	m_MeshesByVertexOffset.erase(mesh.VertexOffset);
+	mesh.VertexOffset = offset;
+	m_MeshesByVertexOffset[offset] = handle;
+	return true;
+}
+
+bool MeshPool::MoveIndices(MeshHandle handle)
+{
+	Mesh& mesh = m_Meshes[handle];
+	unsigned int offset = m_IndexAllocator.AllocateBelow(mesh.IndexCount, mesh.IndexOffset);
+	if (offset == FreeListAllocator::InvalidOffset)
+	{
+		return false;
+	}
+
+	m_IBO->CopySubData(mesh.IndexOffset, offset, mesh.IndexCount);
+	m_IndexAllocator.Free(mesh.IndexOffset, mesh.IndexCount);
+	m_MeshesByIndexOffset.erase(mesh.IndexOffset);
+	mesh.IndexOffset = offset;
+	m_MeshesByIndexOffset[offset] = handle;
+	return true;
+}
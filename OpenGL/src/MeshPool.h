@@ -0,0 +1,102 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "FreeListAllocator.h"
+
+class VertexArray;
+class VertexBuffer;
+class IndexBuffer;
+class VertexBufferLayout;
+class IndirectBuffer;
+class Renderer;
+class Shader;
+
+/** Where a mesh lives inside the pool's shared buffers, fed to glDrawElementsBaseVertex or an indirect command. */
+struct MeshRange
+{
+	unsigned int IndexCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+};
+
+/**
+ * Packs the vertices and indices of many meshes with the same vertex layout into one vertex buffer and one index buffer,
+ * so that a single vertex array serves all of them and they can be submitted with one multi-draw.
+ * Indices stay relative to the mesh's first vertex, moving a mesh only changes its base vertex and first index.
+ */
+class MeshPool
+{
+public:
+	typedef unsigned int MeshHandle;
+	static const MeshHandle InvalidMesh = 0xFFFFFFFF;
+
+	/**
+	 * Capacities are in vertices and indices, both buffers grow on demand.
+	 * Indices are local to each mesh, so GL_UNSIGNED_SHORT is enough as long as no single mesh has more than 65536 vertices.
+	 */
+	MeshPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity, unsigned int indexType = GL_UNSIGNED_INT);
+	~MeshPool();
+
+	/** Copy a mesh into the shared buffers, vertices must match the layout the pool was created with. */
+	MeshHandle AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void RemoveMesh(MeshHandle mesh);
+
+	/** Draw range of a live mesh, it changes whenever Defragment() moves the mesh. */
+	MeshRange GetRange(MeshHandle mesh) const;
+	void Draw(const Renderer& renderer, const Shader& shader, MeshHandle mesh) const;
+	/** Record a draw of the mesh into an indirect buffer, which must be rebuilt after Defragment() moved anything. */
+	void AddDraw(IndirectBuffer& indirect, MeshHandle mesh, unsigned int baseInstance, unsigned int instanceCount = 1) const;
+
+	/**
+	 * Move up to maxMoves meshes from the top of each buffer into holes further down, with GPU side copies.
+	 * Meant to be called once per frame so that compaction cost is spread out.
+	 * Returns the number of vertex and index ranges moved, anything but 0 invalidates previously fetched draw ranges.
+	 */
+	unsigned int Defragment(unsigned int maxMoves = 1);
+
+	/** Shared vertex array, more buffers (e.g. per-instance data) can be attached to it. */
+	inline VertexArray& GetVertexArray() const { return *m_VAO; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IBO; }
+	inline unsigned int GetMeshCount() const { return m_MeshCount; }
+	inline const FreeListAllocator& GetVertexAllocator() const { return m_VertexAllocator; }
+	inline const FreeListAllocator& GetIndexAllocator() const { return m_IndexAllocator; }
+
+private:
+	struct Mesh
+	{
+		unsigned int VertexOffset;
+		unsigned int VertexCount;
+		unsigned int IndexOffset;
+		unsigned int IndexCount;
+		bool bAlive;
+	};
+
+	/** Make room for count more vertices, the vertex buffer keeps its name so the vertex array does not need to be rebuilt. */
+	unsigned int AllocateVertices(unsigned int count);
+	unsigned int AllocateIndices(unsigned int count);
+	bool MoveVertices(MeshHandle mesh);
+	bool MoveIndices(MeshHandle mesh);
+
+private:
+	std::unique_ptr<VertexArray> m_VAO;
+	std::unique_ptr<VertexBuffer> m_VBO;
+	std::unique_ptr<IndexBuffer> m_IBO;
+	unsigned int m_VertexStride;
+
+	FreeListAllocator m_VertexAllocator;
+	FreeListAllocator m_IndexAllocator;
+
+	std::vector<Mesh> m_Meshes;
+	/** Handles of removed meshes for reuse. */
+	std::vector<MeshHandle> m_FreeHandles;
+	unsigned int m_MeshCount;
+
+	/** Live meshes ordered by offset, walked from the top by Defragment(). */
+	std::map<unsigned int, MeshHandle> m_MeshesByVertexOffset;
+	std::map<unsigned int, MeshHandle> m_MeshesByIndexOffset;
+};
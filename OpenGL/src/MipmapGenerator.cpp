@@ -0,0 +1,99 @@
+#include "MipmapGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+
+// SSE2 is part of every x64 CPU, so no runtime dispatch is needed
+#include <emmintrin.h>
+
+unsigned int MipmapGenerator::GetLevelCount(int width, int height)
+{
+	unsigned int levels = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2)
+	{
+		++levels;
+	}
+	return levels;
+}
+
+size_t MipmapGenerator::GetChainSize(int width, int height)
+{
+	size_t size = 0;
+	const unsigned int levels = GetLevelCount(width, height);
+	for (unsigned int level = 0; level < levels; ++level)
+	{
+		size += (size_t)width * height * 4;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return size;
+}
+
+void MipmapGenerator::Downsample(const unsigned char* src, int width, int height, unsigned char* dst)
+{
+	const int dstWidth = std::max(1, width / 2);
+	const int dstHeight = std::max(1, height / 2);
+	const size_t srcPitch = (size_t)width * 4;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+
+	for (int y = 0; y < dstHeight; ++y)
+	{
+		// A 1 pixel high or wide source averages each pixel with itself
+		const unsigned char* row0 = src + 2 * y * srcPitch;
+		const unsigned char* row1 = height > 1 ? row0 + srcPitch : row0;
+		unsigned char* dstRow = dst + (size_t)y * dstWidth * 4;
+
+		int x = 0;
+		if (width > 1)
+		{
+			// 8 source pixels of both rows make 4 destination pixels, channels are summed in 16 bits so nothing is lost before rounding
+			for (; x + 4 <= dstWidth; x += 4)
+			{
+				__m128i sums[2];
+				for (int half = 0; half < 2; ++half)
+				{
+					const __m128i a = _mm_loadu_si128((const __m128i*)(row0 + (x * 2 + half * 4) * 4));
+					const __m128i b = _mm_loadu_si128((const __m128i*)(row1 + (x * 2 + half * 4) * 4));
+					// Vertical sums of source pixels 0,1 and 2,3
+					const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+					const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+					// Horizontal neighbours end up in the lower 64 bits
+					const __m128i lowPair = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+					const __m128i highPair = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+					sums[half] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lowPair, highPair), rounding), 2);
+				}
+				_mm_storeu_si128((__m128i*)(dstRow + x * 4), _mm_packus_epi16(sums[0], sums[1]));
+			}
+		}
+
+		for (; x < dstWidth; ++x)
+		{
+			const int x0 = 2 * x * 4;
+			const int x1 = width > 1 ? x0 + 4 : x0;
+			for (int c = 0; c < 4; ++c)
+			{
+				dstRow[x * 4 + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+			}
+		}
+	}
+}
+
+std::vector<unsigned char> MipmapGenerator::BuildChain(const unsigned char* pixels, int width, int height)
+{
+	std::vector<unsigned char> chain(GetChainSize(width, height));
+	memcpy(chain.data(), pixels, (size_t)width * height * 4);
+
+	unsigned char* level = chain.data();
+	const unsigned int levels = GetLevelCount(width, height);
+	for (unsigned int i = 1; i < levels; ++i)
+	{
+		unsigned char* next = level + (size_t)width * height * 4;
+		Downsample(level, width, height, next);
+		level = next;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	return chain;
+}
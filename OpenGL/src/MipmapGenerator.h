@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * CPU mip chain generation for tightly packed RGBA8 images.
+ * Pure computation without GL, so it can run on worker threads or offline while cooking assets.
+ */
+class MipmapGenerator
+{
+public:
+	/** Levels down to 1x1, including level 0. */
+	static unsigned int GetLevelCount(int width, int height);
+	/** Bytes of the whole chain as laid out by BuildChain(). */
+	static size_t GetChainSize(int width, int height);
+
+	/**
+	 * Halve an image with a 2x2 box filter, dst has to hold max(1, width / 2) x max(1, height / 2) pixels.
+	 * The last row or column of an odd sized image is dropped, like GL does for non-power-of-two mip levels.
+	 */
+	static void Downsample(const unsigned char* src, int width, int height, unsigned char* dst);
+
+	/** Level 0 followed by every smaller level, tightly packed. */
+	static std::vector<unsigned char> BuildChain(const unsigned char* pixels, int width, int height);
+
+};
@@ -0,0 +1,140 @@
+#include "ProgramBinaryCache.h"
+
+#include <direct.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "Renderer.h"
+
+const char* const ProgramBinaryCache::CacheDirectory = "ShaderCache";
+
+// Written in front of every binary, a file from another build of the cache format is simply ignored
+struct ProgramBinaryHeader
+{
+	static const unsigned int CurrentMagic = 0x31425047; // "GPB1"
+
+	unsigned int Magic;
+	unsigned int Format;
+	unsigned int Length;
+};
+
+// 64-bit FNV-1a
+static unsigned long long HashString(const char* data, size_t length, unsigned long long hash = 14695981039346656037ull)
+{
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+static unsigned long long HashGLString(unsigned int name, unsigned long long hash)
+{
+	GLCALL(const char* value = (const char*)glGetString(name));
+	// Hash the terminator too, so that "ab" + "c" and "a" + "bc" differ
+	return value ? HashString(value, strlen(value) + 1, hash) : hash;
+}
+
+bool ProgramBinaryCache::IsSupported()
+{
+	static int s_bSupported = -1;
+	if (s_bSupported == -1)
+	{
+		int formatCount = 0;
+		if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+		{
+			GLCALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+		}
+		s_bSupported = formatCount > 0 ? 1 : 0;
+	}
+	return s_bSupported == 1;
+}
+
+std::string ProgramBinaryCache::MakeKey(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
+{
+	unsigned long long hash = HashString(vertexShaderSource.c_str(), vertexShaderSource.size() + 1);
+	hash = HashString(fragmentShaderSource.c_str(), fragmentShaderSource.size() + 1, hash);
+	hash = HashGLString(GL_VENDOR, hash);
+	hash = HashGLString(GL_RENDERER, hash);
+	hash = HashGLString(GL_VERSION, hash);
+
+	char key[17];
+	snprintf(key, sizeof(key), "%016llx", hash);
+	return key;
+}
+
+bool ProgramBinaryCache::Load(unsigned int program, const std::string& key)
+{
+	if (!IsSupported())
+	{
+		return false;
+	}
+
+	std::ifstream file(GetFilePath(key), std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	ProgramBinaryHeader header;
+	if (!file.read((char*)&header, sizeof(header)) || header.Magic != ProgramBinaryHeader::CurrentMagic)
+	{
+		return false;
+	}
+	// A corrupt or truncated file must not cause an allocation of whatever its header claims
+	const std::streamoff dataStart = file.tellg();
+	file.seekg(0, std::ios::end);
+	const std::streamoff remaining = file.tellg() - dataStart;
+	file.seekg(dataStart);
+	if (header.Length == 0 || (std::streamoff)header.Length > remaining)
+	{
+		return false;
+	}
+	std::vector<char> binary(header.Length);
+	if (!file.read(binary.data(), header.Length))
+	{
+		return false;
+	}
+
+	GLCALL(glProgramBinary(program, header.Format, binary.data(), header.Length));
+	// A driver update may reject binaries it produced before, which is not an error, the caller compiles from source instead
+	int result;
+	GLCALL(glGetProgramiv(program, GL_LINK_STATUS, &result));
+	return result == GL_TRUE;
+}
+
+void ProgramBinaryCache::Save(unsigned int program, const std::string& key)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	int length = 0;
+	GLCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(length);
+	ProgramBinaryHeader header = { ProgramBinaryHeader::CurrentMagic, 0, 0 };
+	GLCALL(glGetProgramBinary(program, length, &length, &header.Format, binary.data()));
+	header.Length = length;
+
+	// Fails harmlessly if the directory already exists
+	_mkdir(CacheDirectory);
+	std::ofstream file(GetFilePath(key), std::ios::binary | std::ios::trunc);
+	if (!file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), length))
+	{
+		std::cout << "Warning: failed to write program binary cache entry '" << key << "'!" << std::endl;
+	}
+}
+
+std::string ProgramBinaryCache::GetFilePath(const std::string& key)
+{
+	return std::string(CacheDirectory) + "/" + key + ".bin";
+}
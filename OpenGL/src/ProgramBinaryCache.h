@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+/**
+ * On-disk cache of linked programs, so that a shader only has to be compiled the first time it is used on a given driver.
+ * Entries are keyed by a hash of the sources together with the GL vendor, renderer and version strings,
+ * since binaries are only guaranteed to load on the driver which produced them.
+ */
+class ProgramBinaryCache
+{
+public:
+	/** Whether the context supports program binaries(GL 4.1 or ARB_get_program_binary) with at least one format. */
+	static bool IsSupported();
+
+	static std::string MakeKey(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
+
+	/** Restore a cached binary into program, false if there is none or the driver rejected it. */
+	static bool Load(unsigned int program, const std::string& key);
+	/** Store the binary of a successfully linked program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT should have been set before linking. */
+	static void Save(unsigned int program, const std::string& key);
+
+private:
+	static std::string GetFilePath(const std::string& key);
+
+private:
+	/** Relative to the working directory. */
+	static const char* const CacheDirectory;
+
+};
@@ -0,0 +1,139 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+#include "Renderer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+#include "UniformRing.h"
+
+static const unsigned int s_DepthBits = 24;
+static const unsigned int s_IDBits = 16;
+static const uint64_t s_DepthMask = (1ull << s_DepthBits) - 1;
+static const uint64_t s_IDMask = (1ull << s_IDBits) - 1;
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& model,
+	float depth, unsigned int layer, bool bTranslucent)
+{
+	const unsigned int textureID = texture ? texture->GetRendererID() : 0;
+	m_SortEntries.push_back({ MakeSortKey(shader.GetRendererID(), textureID, depth, layer, bTranslucent), (unsigned int)m_Commands.size() });
+	m_Commands.push_back({ &va, &ib, &shader, texture, model });
+}
+
+void RenderQueue::Flush(const Renderer& renderer)
+{
+	RadixSort();
+
+	if (!m_ObjectUniforms)
+	{
+		m_ObjectUniforms.reset(new UniformRing());
+	}
+	m_ObjectUniforms->BeginFrame();
+
+	unsigned char objectData[ObjectBlockLayout::GetSize()];
+	for (const SortEntry& entry : m_SortEntries)
+	{
+		const DrawCommand& command = m_Commands[entry.CommandIndex];
+		// Consecutive draws mostly share shader and texture now, the state cache will skip the rebinds
+		if (command.Texture0)
+		{
+			command.Texture0->Bind(0);
+		}
+		command.Program->Bind();
+		ObjectBlockLayout::Write<0>(objectData, command.Model);
+		m_ObjectUniforms->Push(ObjectBlockBinding, objectData, sizeof(objectData));
+		renderer.Draw(*command.VA, *command.IB, *command.Program);
+	}
+
+	m_ObjectUniforms->EndFrame();
+
+	m_Commands.clear();
+	m_SortEntries.clear();
+}
+
+uint64_t RenderQueue::MakeSortKey(unsigned int shaderID, unsigned int textureID, float depth, unsigned int layer, bool bTranslucent)
+{
+	ASSERT(layer < MaxLayers);
+
+	uint64_t quantizedDepth = (uint64_t)(std::min(std::max(depth, 0.f), 1.f) * s_DepthMask);
+	uint64_t key = (uint64_t)layer << 60;
+	if (bTranslucent)
+	{
+		// Farther ones have smaller keys
+		quantizedDepth = s_DepthMask - quantizedDepth;
+		key |= 1ull << 59;
+		key |= quantizedDepth << 35;
+		key |= (shaderID & s_IDMask) << 19;
+		key |= (textureID & s_IDMask) << 3;
+	}
+	else
+	{
+		// Material first to minimize state changes, then front-to-back to benefit from early depth test
+		key |= (shaderID & s_IDMask) << 43;
+		key |= (textureID & s_IDMask) << 27;
+		key |= quantizedDepth << 3;
+	}
+	return key;
+}
+
+void RenderQueue::RadixSort()
+{
+	const size_t count = m_SortEntries.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	m_SortScratch.resize(count);
+	SortEntry* src = m_SortEntries.data();
+	SortEntry* dst = m_SortScratch.data();
+
+	// Bits that differ among keys, passes over bytes that are identical for all keys can be skipped
+	uint64_t diffBits = 0;
+	for (size_t i = 1; i < count; ++i)
+	{
+		diffBits |= src[i].Key ^ src[0].Key;
+	}
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		if (((diffBits >> shift) & 0xFF) == 0)
+		{
+			continue;
+		}
+
+		unsigned int offsets[256] = {};
+		for (size_t i = 0; i < count; ++i)
+		{
+			++offsets[(src[i].Key >> shift) & 0xFF];
+		}
+		// Exclusive prefix sum turns the histogram into output positions
+		unsigned int sum = 0;
+		for (unsigned int b = 0; b < 256; ++b)
+		{
+			unsigned int bucketCount = offsets[b];
+			offsets[b] = sum;
+			sum += bucketCount;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			dst[offsets[(src[i].Key >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	// The result ends up in the scratch buffer after an odd number of passes
+	if (src != m_SortEntries.data())
+	{
+		m_SortEntries.swap(m_SortScratch);
+	}
+}
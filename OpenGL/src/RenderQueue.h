@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+class Renderer;
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class Texture;
+class UniformRing;
+
+/**
+ * Deferred draw submission.
+ * Draws are recorded with a packed 64-bit sort key and executed in key order on Flush(),
+ * so that draws sharing a shader and texture end up adjacent and translucent draws are rendered back-to-front.
+ *
+ * Key layout(from most significant bit):
+ * | layer(4) | translucent(1) | opaque: shader(16) texture(16) depth(24) | translucent: inverted depth(24) shader(16) texture(16) | unused(3) |
+ */
+class RenderQueue
+{
+public:
+	struct DrawCommand
+	{
+		const VertexArray* VA;
+		const IndexBuffer* IB;
+		Shader* Program;
+		/** Bound to slot 0, can be null. */
+		const Texture* Texture0;
+		/** Pushed to the ObjectData uniform block right before drawing. */
+		glm::mat4 Model;
+	};
+
+	static const unsigned int MaxLayers = 16;
+
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	/**
+	 * Record a draw, nothing is sent to GL until Flush().
+	 * The shader reads the model matrix from its ObjectData block, frame data is expected to be bound to FrameBlockBinding by the caller.
+	 * @param depth - Normalized distance to the camera in [0, 1], 0 means nearest
+	 * @param layer - Lower layers are always drawn first regardless of the other fields, must be less than MaxLayers
+	 * @param bTranslucent - Translucent draws go after all opaque ones of the same layer and are sorted back-to-front
+	 */
+	void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& model,
+		float depth = 0.f, unsigned int layer = 0, bool bTranslucent = false);
+
+	/** Sort all the recorded draws, issue them and clear the queue. */
+	void Flush(const Renderer& renderer);
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Commands.size(); }
+
+	static uint64_t MakeSortKey(unsigned int shaderID, unsigned int textureID, float depth, unsigned int layer, bool bTranslucent);
+
+private:
+	/** Stable LSD radix sort of m_SortEntries by key, 8 bits per pass. */
+	void RadixSort();
+
+private:
+	struct SortEntry
+	{
+		uint64_t Key;
+		unsigned int CommandIndex;
+	};
+
+	std::vector<DrawCommand> m_Commands;
+	std::vector<SortEntry> m_SortEntries;
+	/** Scratch buffer of radix sort, kept to avoid reallocating every flush. */
+	std::vector<SortEntry> m_SortScratch;
+
+	/** Per-object uniform data, created on first flush so that the queue can be constructed before GL. */
+	std::unique_ptr<UniformRing> m_ObjectUniforms;
+
+};
@@ -0,0 +1,198 @@
+#include "RenderThread.h"
+
+#include <cstring>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "UniformRing.h"
+
+#include "imgui/imgui_impl_opengl3.h"
+
+FramePacket::~FramePacket()
+{
+	for (ImDrawList* drawList : DrawLists)
+	{
+		IM_DELETE(drawList);
+	}
+}
+
+// Copy the buffers into the packet's own draw lists, reusing their memory across frames
+static void CopyDrawData(const ImDrawData& src, FramePacket& packet)
+{
+	while ((int)packet.DrawLists.size() < src.CmdListsCount)
+	{
+		packet.DrawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+	}
+
+	for (int i = 0; i < src.CmdListsCount; ++i)
+	{
+		const ImDrawList* srcList = src.CmdLists[i];
+		ImDrawList* dstList = packet.DrawLists[i];
+		dstList->CmdBuffer.resize(srcList->CmdBuffer.Size);
+		memcpy(dstList->CmdBuffer.Data, srcList->CmdBuffer.Data, srcList->CmdBuffer.size_in_bytes());
+		dstList->IdxBuffer.resize(srcList->IdxBuffer.Size);
+		memcpy(dstList->IdxBuffer.Data, srcList->IdxBuffer.Data, srcList->IdxBuffer.size_in_bytes());
+		dstList->VtxBuffer.resize(srcList->VtxBuffer.Size);
+		memcpy(dstList->VtxBuffer.Data, srcList->VtxBuffer.Data, srcList->VtxBuffer.size_in_bytes());
+		dstList->Flags = srcList->Flags;
+	}
+
+	packet.DrawData = src;
+	packet.DrawData.CmdLists = packet.DrawLists.data();
+}
+
+RenderThread::RenderThread(GLFWwindow* window, unsigned int frameCount)
+	: m_Window(window)
+	, m_CurrentPacket(nullptr)
+	, m_SubmittedCount(0)
+	, m_CompletedCount(0)
+	, m_bStopping(false)
+{
+	for (unsigned int i = 0; i < frameCount; ++i)
+	{
+		m_Packets.emplace_back(new FramePacket());
+		m_FreePackets.push_back(m_Packets.back().get());
+	}
+
+	// A context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	m_Thread = std::thread(&RenderThread::ThreadLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bStopping = true;
+	}
+	m_WorkAvailable.notify_all();
+	m_Thread.join();
+
+	glfwMakeContextCurrent(m_Window);
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+	ASSERT(!m_CurrentPacket);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkCompleted.wait(lock, [this]() { return !m_FreePackets.empty(); });
+	m_CurrentPacket = m_FreePackets.back();
+	m_FreePackets.pop_back();
+	lock.unlock();
+
+	m_CurrentPacket->Commands.Reset();
+	m_CurrentPacket->ImmediateRender = nullptr;
+	return *m_CurrentPacket;
+}
+
+void RenderThread::EndFrame(bool bWaitUntilRendered)
+{
+	ASSERT(m_CurrentPacket);
+
+	CopyDrawData(*ImGui::GetDrawData(), *m_CurrentPacket);
+	unsigned long long sequence = Submit({ m_CurrentPacket, nullptr });
+	m_CurrentPacket = nullptr;
+
+	if (bWaitUntilRendered)
+	{
+		WaitForCompletion(sequence);
+	}
+}
+
+void RenderThread::ExecuteSync(const std::function<void()>& task)
+{
+	// The task is referenced rather than copied as we will not return before it finishes
+	WaitForCompletion(Submit({ nullptr, &task }));
+}
+
+unsigned long long RenderThread::Submit(const WorkItem& item)
+{
+	unsigned long long sequence;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.push_back(item);
+		sequence = ++m_SubmittedCount;
+	}
+	m_WorkAvailable.notify_one();
+	return sequence;
+}
+
+void RenderThread::WaitForCompletion(unsigned long long sequence)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkCompleted.wait(lock, [this, sequence]() { return m_CompletedCount >= sequence; });
+}
+
+void RenderThread::ThreadLoop()
+{
+	glfwMakeContextCurrent(m_Window);
+
+	// Backs the uniform blocks recorded into frame packets, lives on this thread like every other GL object it owns
+	std::unique_ptr<UniformRing> uniformRing(new UniformRing(4 * 1024 * 1024));
+
+	while (true)
+	{
+		WorkItem item;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkAvailable.wait(lock, [this]() { return m_bStopping || !m_Queue.empty(); });
+			// Drain the queue before stopping
+			if (m_Queue.empty())
+			{
+				break;
+			}
+			item = m_Queue.front();
+			m_Queue.pop_front();
+		}
+
+		if (item.Packet)
+		{
+			RenderPacket(*item.Packet, *uniformRing);
+		}
+		else
+		{
+			(*item.Task)();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			++m_CompletedCount;
+			if (item.Packet)
+			{
+				m_FreePackets.push_back(item.Packet);
+			}
+		}
+		m_WorkCompleted.notify_all();
+	}
+
+	uniformRing.reset();
+	glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::RenderPacket(FramePacket& packet, UniformRing& uniformRing)
+{
+	GLStateCache::ResetStats();
+
+	Renderer renderer;
+	GLCALL(glClearColor(0.f, 0.f, 0.f, 1.f));
+	renderer.Clear();
+
+	uniformRing.BeginFrame();
+	packet.Commands.Execute(renderer, &uniformRing);
+	uniformRing.EndFrame();
+	if (packet.ImmediateRender)
+	{
+		packet.ImmediateRender();
+	}
+
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplOpenGL3_RenderDrawData(&packet.DrawData);
+	// ImGui changes GL state behind the cache's back
+	GLStateCache::Invalidate();
+
+	glfwSwapBuffers(m_Window);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CommandList.h"
+
+#include "imgui/imgui.h"
+
+struct GLFWwindow;
+class UniformRing;
+
+/** Everything the render thread needs to draw one frame, filled by the main thread. */
+struct FramePacket
+{
+	CommandList Commands;
+	/** Rendering which cannot be recorded, executed after Commands on the render thread. */
+	std::function<void()> ImmediateRender;
+
+	/** Deep copy of ImGui draw data, ImGui overwrites its own as soon as next frame starts. */
+	ImDrawData DrawData;
+	std::vector<ImDrawList*> DrawLists;
+
+	FramePacket() {}
+	~FramePacket();
+};
+
+/**
+ * Owns the GL context and executes frame packets on a dedicated thread,
+ * so that the main thread can simulate and build frame N+1 while frame N is being submitted and presented.
+ * Frame packets are recycled, at most frameCount of them can be in flight which bounds the latency.
+ */
+class RenderThread
+{
+public:
+	/** The context of window MUST be current on the calling thread, it will be moved to the render thread. */
+	RenderThread(GLFWwindow* window, unsigned int frameCount = 2);
+	/** Finish all queued work and make the context current on the calling thread again. */
+	~RenderThread();
+
+	/** Get a free frame packet to fill, blocks if all the packets are in flight. */
+	FramePacket& BeginFrame();
+	/**
+	 * Snapshot ImGui draw data into the packet and queue it.
+	 * @param bWaitUntilRendered - Block until the frame has been rendered, needed if ImmediateRender reads state the main thread will modify
+	 */
+	void EndFrame(bool bWaitUntilRendered = false);
+
+	/** Run task on the render thread after all the queued work and wait for it, used for creating or destroying GL resources. */
+	void ExecuteSync(const std::function<void()>& task);
+
+private:
+	struct WorkItem
+	{
+		FramePacket* Packet;
+		const std::function<void()>* Task;
+	};
+
+	void ThreadLoop();
+	/** Queue an item and return its sequence number. */
+	unsigned long long Submit(const WorkItem& item);
+	void WaitForCompletion(unsigned long long sequence);
+	void RenderPacket(FramePacket& packet, UniformRing& uniformRing);
+
+private:
+	GLFWwindow* m_Window;
+	std::thread m_Thread;
+
+	std::vector<std::unique_ptr<FramePacket>> m_Packets;
+	std::vector<FramePacket*> m_FreePackets;
+	FramePacket* m_CurrentPacket;
+
+	std::deque<WorkItem> m_Queue;
+	unsigned long long m_SubmittedCount;
+	unsigned long long m_CompletedCount;
+	bool m_bStopping;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_WorkCompleted;
+
+};
@@ -5,6 +5,7 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "IndirectBuffer.h"
 
 void GLClearError()
 {
@@ -37,11 +38,85 @@ void Renderer::Clear() const
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+	Draw(va, ib, shader, ib.GetCount());
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount, int baseVertex, unsigned int firstIndex) const
+{
+	// Still compiling in the background, drawing would stall until it is done
+	if (!shader.IsReady())
+	{
+		return;
+	}
+
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
+#ifdef DEBUG
+	va.Validate(shader);
+#endif
 	// Issue a drawcall
 	// The count is actually the number of indices rather than vertices
-	// Since index buffer is already bound to GL_ELEMENT_ARRAY_BUFFER, we do not need to specify the pointer to indices
-	GLCALL(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+	// Since index buffer is already bound to GL_ELEMENT_ARRAY_BUFFER, the pointer is a byte offset into it
+	// Not const, GLEW declares glDrawElementsBaseVertex with a plain void*
+	void* indices = (void*)(size_t)(firstIndex * ib.GetIndexSize());
+	if (baseVertex != 0)
+	{
+		GLCALL(glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, ib.GetIndexType(), indices, baseVertex));
+	}
+	else
+	{
+		GLCALL(glDrawElements(GL_TRIANGLES, indexCount, ib.GetIndexType(), indices));
+	}
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+	if (!shader.IsReady())
+	{
+		return;
+	}
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+#ifdef DEBUG
+	va.Validate(shader);
+#endif
+	GLCALL(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetIndexType(), nullptr, instanceCount));
+}
+
+void Renderer::MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect) const
+{
+	if (indirect.GetCount() == 0 || !shader.IsReady())
+	{
+		return;
+	}
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+#ifdef DEBUG
+	va.Validate(shader);
+#endif
+	if (GLEW_VERSION_4_3)
+	{
+		indirect.Bind();
+		// Commands are read from the bound GL_DRAW_INDIRECT_BUFFER, starting at offset 0
+		GLCALL(glMultiDrawElementsIndirect(GL_TRIANGLES, ib.GetIndexType(), nullptr, indirect.GetCount(), 0));
+		return;
+	}
+
+	for (const DrawElementsIndirectCommand& command : indirect.GetCommands())
+	{
+		const void* indices = (const void*)(size_t)(command.FirstIndex * ib.GetIndexSize());
+		if (GLEW_VERSION_4_2)
+		{
+			GLCALL(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.Count, ib.GetIndexType(), indices, command.InstanceCount, command.BaseVertex, command.BaseInstance));
+		}
+		else
+		{
+			GLCALL(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, ib.GetIndexType(), indices, command.InstanceCount, command.BaseVertex));
+		}
+	}
 }
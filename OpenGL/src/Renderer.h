@@ -5,6 +5,7 @@
 class VertexArray;
 class IndexBuffer;
 class Shader;
+class IndirectBuffer;
 
 #define WINDOW_WIDTH 960.f
 #define WINDOW_HEIGHT 540.f
@@ -31,6 +32,15 @@ public:
 
 	void Clear() const;
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	/** Draw indexCount indices of the index buffer starting at firstIndex, baseVertex is added to every index. */
+	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount, int baseVertex = 0, unsigned int firstIndex = 0) const;
+	/** Draw instanceCount copies of the geometry with one draw call, per-instance data should come from vertex attributes with a divisor. */
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+	/**
+	 * Issue all the commands of the uploaded indirect buffer with one glMultiDrawElementsIndirect call.
+	 * Falls back to one draw per command on contexts older than GL 4.3, base instance is ignored below GL 4.2.
+	 */
+	void MultiDrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const IndirectBuffer& indirect) const;
 
 private:
 
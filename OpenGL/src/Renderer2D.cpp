@@ -0,0 +1,262 @@
+#include "Renderer2D.h"
+
+#include <cstring>
+
+#include "Renderer.h"
+#include "VertexArray.h"
+#include "StreamBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureArray.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+// Unit quad centered at origin, in counter-clockwise order
+static const glm::vec4 s_QuadPositions[4] = {
+	{ -0.5f, -0.5f, 0.f, 1.f },
+	{  0.5f, -0.5f, 0.f, 1.f },
+	{  0.5f,  0.5f, 0.f, 1.f },
+	{ -0.5f,  0.5f, 0.f, 1.f }
+};
+
+static const glm::vec2 s_QuadTexCoords[4] = {
+	{ 0.f, 0.f },
+	{ 1.f, 0.f },
+	{ 1.f, 1.f },
+	{ 0.f, 1.f }
+};
+
+Renderer2D::Renderer2D()
+	: m_QuadVertices(new QuadVertex[MaxVertices])
+	, m_QuadVertexPtr(nullptr)
+	, m_QuadIndexCount(0)
+	, m_TextureSlots{}
+	, m_TextureSlotIndex(0)
+	, m_TextureArray(nullptr)
+{
+	m_VAO.reset(new VertexArray());
+
+	// Room for two full batches per frame before the ring has to move on to the next region
+	m_StreamBuffer.reset(new StreamBuffer(GL_ARRAY_BUFFER, 2 * MaxVertices * sizeof(QuadVertex)));
+
+	VertexBufferLayout layout;
+	// Vertex position
+	layout.Push<float>(3);
+	// Vertex color
+	layout.Push<float>(4);
+	// Texture coordinate
+	layout.Push<float>(2);
+	// Texture slot index, negative means no texture
+	layout.Push<float>(1);
+	// Texture array layer, negative means none
+	layout.Push<float>(1);
+	m_VAO->AddBuffer(*m_StreamBuffer, layout);
+
+	// Every quad uses the same index pattern, so the index buffer can be built once up front
+	std::unique_ptr<unsigned int[]> indices(new unsigned int[MaxIndices]);
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < MaxIndices; i += 6)
+	{
+		indices[i + 0] = offset + 0;
+		indices[i + 1] = offset + 1;
+		indices[i + 2] = offset + 2;
+
+		indices[i + 3] = offset + 2;
+		indices[i + 4] = offset + 3;
+		indices[i + 5] = offset + 0;
+
+		offset += 4;
+	}
+	m_IBO.reset(new IndexBuffer(indices.get(), MaxIndices));
+
+	m_Shader.reset(new Shader("res/shaders/Batch.shader"));
+	m_Shader->Bind();
+	int samplers[MaxTextureSlots];
+	for (unsigned int i = 0; i < MaxTextureSlots; ++i)
+	{
+		samplers[i] = i;
+	}
+	m_Shader->SetUniform1iv("u_Textures", MaxTextureSlots, samplers);
+	m_Shader->SetUniform1i("u_TextureArray", TextureArraySlot);
+	m_ViewProjUniform = m_Shader->GetUniformHandle("u_ViewProj");
+}
+
+Renderer2D::~Renderer2D()
+{
+}
+
+void Renderer2D::BeginBatch(const glm::mat4& viewProj)
+{
+	m_Shader->Bind();
+	m_Shader->SetUniformMat4f(m_ViewProjUniform, viewProj);
+
+	m_StreamBuffer->BeginFrame();
+
+	m_QuadVertexPtr = m_QuadVertices.get();
+	m_QuadIndexCount = 0;
+	m_TextureSlotIndex = 0;
+	m_TextureArray = nullptr;
+}
+
+void Renderer2D::EndBatch()
+{
+	Flush();
+	m_StreamBuffer->EndFrame();
+}
+
+void Renderer2D::Flush()
+{
+	if (m_QuadIndexCount == 0)
+	{
+		return;
+	}
+
+	unsigned int dataSize = (unsigned int)((unsigned char*)m_QuadVertexPtr - (unsigned char*)m_QuadVertices.get());
+	// Align to the vertex size so that the offset can be expressed as a base vertex
+	StreamBuffer::Allocation allocation = m_StreamBuffer->Allocate(dataSize, sizeof(QuadVertex));
+	if (!allocation.Data)
+	{
+		// Region is full, all the draws reading it have been issued so it can be fenced early
+		m_StreamBuffer->EndFrame();
+		m_StreamBuffer->BeginFrame();
+		allocation = m_StreamBuffer->Allocate(dataSize, sizeof(QuadVertex));
+	}
+	memcpy(allocation.Data, m_QuadVertices.get(), dataSize);
+	m_StreamBuffer->Flush(allocation);
+
+	for (unsigned int i = 0; i < m_TextureSlotIndex; ++i)
+	{
+		m_TextureSlots[i]->Bind(i);
+	}
+	if (m_TextureArray)
+	{
+		m_TextureArray->Bind(TextureArraySlot);
+	}
+
+	Renderer renderer;
+	renderer.Draw(*m_VAO, *m_IBO, *m_Shader, m_QuadIndexCount, (int)(allocation.Offset / sizeof(QuadVertex)));
+	++m_Stats.DrawCalls;
+
+	// Start over, keep the view projection matrix
+	m_QuadVertexPtr = m_QuadVertices.get();
+	m_QuadIndexCount = 0;
+	m_TextureSlotIndex = 0;
+	m_TextureArray = nullptr;
+}
+
+void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color)
+{
+	glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(size, 1.f));
+	DrawQuad(transform, color);
+}
+
+void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tintColor)
+{
+	glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(size, 1.f));
+	DrawQuad(transform, texture, tintColor);
+}
+
+void Renderer2D::DrawQuad(const glm::mat4& transform, const glm::vec4& color)
+{
+	if (m_QuadIndexCount >= MaxIndices)
+	{
+		Flush();
+	}
+
+	SubmitQuad(transform, color, -1.f);
+}
+
+void Renderer2D::DrawQuad(const glm::mat4& transform, const Texture& texture, const glm::vec4& tintColor)
+{
+	// Flush before resolving the texture slot, otherwise the slot would be lost
+	if (m_QuadIndexCount >= MaxIndices)
+	{
+		Flush();
+	}
+
+	float texIndex = GetTextureSlot(texture);
+	SubmitQuad(transform, tintColor, texIndex);
+}
+
+void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tintColor)
+{
+	glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(size, 1.f));
+	DrawQuad(transform, region, tintColor);
+}
+
+void Renderer2D::DrawQuad(const glm::mat4& transform, const AtlasRegion& region, const glm::vec4& tintColor)
+{
+	// An image which did not fit into the atlas has no page
+	ASSERT(region.Page);
+
+	if (m_QuadIndexCount >= MaxIndices)
+	{
+		Flush();
+	}
+
+	float texIndex = GetTextureSlot(*region.Page);
+	SubmitQuad(transform, tintColor, texIndex, region.UVMin, region.UVMax);
+}
+
+void Renderer2D::DrawQuad(const glm::vec3& position, const glm::vec2& size, const TextureArray& textureArray, unsigned int layer, const glm::vec4& tintColor)
+{
+	glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(size, 1.f));
+	DrawQuad(transform, textureArray, layer, tintColor);
+}
+
+void Renderer2D::DrawQuad(const glm::mat4& transform, const TextureArray& textureArray, unsigned int layer, const glm::vec4& tintColor)
+{
+	if (m_QuadIndexCount >= MaxIndices || (m_TextureArray && m_TextureArray != &textureArray))
+	{
+		Flush();
+	}
+
+	m_TextureArray = &textureArray;
+	SubmitQuad(transform, tintColor, -1.f, glm::vec2(0.f), glm::vec2(1.f), (float)layer);
+}
+
+void Renderer2D::ResetStats()
+{
+	m_Stats = Statistics();
+}
+
+void Renderer2D::SubmitQuad(const glm::mat4& transform, const glm::vec4& color, float texIndex, const glm::vec2& uvMin, const glm::vec2& uvMax, float texLayer)
+{
+	// BeginBatch() must be called first
+	ASSERT(m_QuadVertexPtr);
+
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		m_QuadVertexPtr->Position = transform * s_QuadPositions[i];
+		m_QuadVertexPtr->Color = color;
+		m_QuadVertexPtr->TexCoord = uvMin + s_QuadTexCoords[i] * (uvMax - uvMin);
+		m_QuadVertexPtr->TexIndex = texIndex;
+		m_QuadVertexPtr->TexLayer = texLayer;
+		++m_QuadVertexPtr;
+	}
+
+	m_QuadIndexCount += 6;
+	++m_Stats.QuadCount;
+}
+
+float Renderer2D::GetTextureSlot(const Texture& texture)
+{
+	for (unsigned int i = 0; i < m_TextureSlotIndex; ++i)
+	{
+		if (m_TextureSlots[i] == &texture)
+		{
+			return (float)i;
+		}
+	}
+
+	if (m_TextureSlotIndex >= MaxTextureSlots)
+	{
+		Flush();
+	}
+
+	m_TextureSlots[m_TextureSlotIndex] = &texture;
+	return (float)m_TextureSlotIndex++;
+}
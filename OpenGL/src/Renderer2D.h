@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+
+class VertexArray;
+class StreamBuffer;
+class IndexBuffer;
+class Texture;
+class TextureArray;
+struct AtlasRegion;
+
+/**
+ * Batched quad renderer.
+ * Quads are transformed on the CPU and accumulated into a vertex array,
+ * the whole batch is then copied into a streaming ring buffer and submitted with a single draw call when the array fills up, the texture slots run out or Flush() is called.
+ */
+class Renderer2D
+{
+public:
+	struct QuadVertex
+	{
+		glm::vec3 Position;
+		glm::vec4 Color;
+		glm::vec2 TexCoord;
+		float TexIndex;
+		/** Layer of the bound TextureArray, negative means TexIndex applies. */
+		float TexLayer;
+	};
+
+	struct Statistics
+	{
+		unsigned int DrawCalls = 0;
+		unsigned int QuadCount = 0;
+	};
+
+	static const unsigned int MaxQuads = 10000;
+	static const unsigned int MaxVertices = MaxQuads * 4;
+	static const unsigned int MaxIndices = MaxQuads * 6;
+	/** Must match the sampler array size in Batch.shader. */
+	static const unsigned int MaxTextureSlots = 15;
+	/** The texture unit after the 2D slots, GL 3.3 only guarantees 16 units to fragment shaders. */
+	static const unsigned int TextureArraySlot = MaxTextureSlots;
+
+public:
+	Renderer2D();
+	~Renderer2D();
+
+	/** Start a new batch, viewProj will be applied to all quads until next BeginBatch(). */
+	void BeginBatch(const glm::mat4& viewProj);
+	/** Submit the remaining quads, every BeginBatch() MUST be paired with an EndBatch(). */
+	void EndBatch();
+	/** Submit all the quads accumulated so far with one draw call and start over. */
+	void Flush();
+
+	/** Draw a flat colored quad, position means the quad center. */
+	void DrawQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec4& color);
+	/** Draw a textured quad, position means the quad center. */
+	void DrawQuad(const glm::vec3& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tintColor = glm::vec4(1.f));
+	/** Draw a flat colored unit quad transformed by transform. */
+	void DrawQuad(const glm::mat4& transform, const glm::vec4& color);
+	/** Draw a textured unit quad transformed by transform. */
+	void DrawQuad(const glm::mat4& transform, const Texture& texture, const glm::vec4& tintColor = glm::vec4(1.f));
+	/** Draw a sprite from a TextureAtlas, position means the quad center. Sprites sharing a page batch like one texture. */
+	void DrawQuad(const glm::vec3& position, const glm::vec2& size, const AtlasRegion& region, const glm::vec4& tintColor = glm::vec4(1.f));
+	/** Draw a sprite from a TextureAtlas on a unit quad transformed by transform. */
+	void DrawQuad(const glm::mat4& transform, const AtlasRegion& region, const glm::vec4& tintColor = glm::vec4(1.f));
+	/** Draw a layer of a texture array, position means the quad center. One array is bound per batch, switching to another one flushes. */
+	void DrawQuad(const glm::vec3& position, const glm::vec2& size, const TextureArray& textureArray, unsigned int layer, const glm::vec4& tintColor = glm::vec4(1.f));
+	/** Draw a layer of a texture array on a unit quad transformed by transform. */
+	void DrawQuad(const glm::mat4& transform, const TextureArray& textureArray, unsigned int layer, const glm::vec4& tintColor = glm::vec4(1.f));
+
+	inline const Statistics& GetStats() const { return m_Stats; }
+	void ResetStats();
+
+private:
+	/** uvMin and uvMax are the texture coordinates of the bottom left and top right corners. */
+	void SubmitQuad(const glm::mat4& transform, const glm::vec4& color, float texIndex, const glm::vec2& uvMin = glm::vec2(0.f), const glm::vec2& uvMax = glm::vec2(1.f), float texLayer = -1.f);
+	/** Return the texture slot the texture will be bound to, flush the batch if all slots are occupied. */
+	float GetTextureSlot(const Texture& texture);
+
+private:
+	std::unique_ptr<VertexArray> m_VAO;
+	/** Vertices of every flush go into a new range of the ring, so uploading never waits for previous draws. */
+	std::unique_ptr<StreamBuffer> m_StreamBuffer;
+	std::unique_ptr<IndexBuffer> m_IBO;
+	std::unique_ptr<Shader> m_Shader;
+	/** Resolved once, set on every BeginBatch(). */
+	UniformHandle m_ViewProjUniform;
+
+	/** CPU side copy of the vertices of current batch. */
+	std::unique_ptr<QuadVertex[]> m_QuadVertices;
+	QuadVertex* m_QuadVertexPtr;
+	unsigned int m_QuadIndexCount;
+
+	std::array<const Texture*, MaxTextureSlots> m_TextureSlots;
+	unsigned int m_TextureSlotIndex;
+	/** Bound to TextureArraySlot on Flush(), nullptr if the batch uses none. */
+	const TextureArray* m_TextureArray;
+
+	Statistics m_Stats;
+
+};
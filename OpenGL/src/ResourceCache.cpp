@@ -0,0 +1,172 @@
+#include "ResourceCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <list>
+#include <unordered_map>
+
+#include "Shader.h"
+
+static ResourceCache::Statistics s_Stats;
+static unsigned int s_RetainedCount = 16;
+
+// Live objects of one type by key, plus the ones nobody holds anymore in least recently released order
+template<typename T>
+class ResourcePool
+{
+public:
+	template<typename CreateFunction>
+	std::shared_ptr<T> Get(const std::string& key, CreateFunction create)
+	{
+		std::weak_ptr<T>& liveEntry = m_Live[key];
+		std::shared_ptr<T> resource = liveEntry.lock();
+		if (resource)
+		{
+			++s_Stats.Hits;
+			return resource;
+		}
+
+		std::unique_ptr<T> object;
+		auto released = m_ReleasedByKey.find(key);
+		if (released != m_ReleasedByKey.end())
+		{
+			object = std::move(released->second->Object);
+			m_Released.erase(released->second);
+			m_ReleasedByKey.erase(released);
+			++s_Stats.Revivals;
+		}
+		else
+		{
+			object.reset(create());
+			++s_Stats.Loads;
+		}
+
+		// Instead of being destroyed, the object goes back to the pool once the last user lets go
+		resource.reset(object.release(), [this, key](T* expired) { Release(key, expired); });
+		liveEntry = resource;
+		return resource;
+	}
+
+	void Trim()
+	{
+		while (m_Released.size() > s_RetainedCount)
+		{
+			m_ReleasedByKey.erase(m_Released.back().Key);
+			m_Released.pop_back();
+			++s_Stats.Evictions;
+		}
+	}
+
+	void Clear()
+	{
+		m_ReleasedByKey.clear();
+		m_Released.clear();
+	}
+
+	unsigned int GetLiveCount()
+	{
+		unsigned int count = 0;
+		for (auto it = m_Live.begin(); it != m_Live.end();)
+		{
+			// Drop entries of released objects while at it
+			if (it->second.expired())
+			{
+				it = m_Live.erase(it);
+			}
+			else
+			{
+				++count;
+				++it;
+			}
+		}
+		return count;
+	}
+
+private:
+	void Release(const std::string& key, T* object)
+	{
+		m_Live.erase(key);
+		m_Released.push_front(ReleasedEntry{ key, std::unique_ptr<T>(object) });
+		m_ReleasedByKey[key] = m_Released.begin();
+		Trim();
+	}
+
+private:
+	struct ReleasedEntry
+	{
+		std::string Key;
+		std::unique_ptr<T> Object;
+	};
+
+	std::unordered_map<std::string, std::weak_ptr<T>> m_Live;
+	/** Most recently released first. */
+	std::list<ReleasedEntry> m_Released;
+	std::unordered_map<std::string, typename std::list<ReleasedEntry>::iterator> m_ReleasedByKey;
+};
+
+static ResourcePool<Texture> s_Textures;
+static ResourcePool<Shader> s_Shaders;
+
+// One spelling per file, Windows paths are case-insensitive and accept either separator
+static std::string GetCanonicalPath(const std::string& filePath)
+{
+	char buffer[_MAX_PATH];
+	std::string path = _fullpath(buffer, filePath.c_str(), _MAX_PATH) ? buffer : filePath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	std::transform(path.begin(), path.end(), path.begin(), [](char c) { return (char)tolower((unsigned char)c); });
+	return path;
+}
+
+std::shared_ptr<Texture> ResourceCache::GetTexture(const std::string& filePath, const TextureOptions& options)
+{
+	// Anisotropy is sampling state which can change on the existing texture(see Texture::SetAnisotropy()), only the mip chain needs a texture of its own
+	const std::string key = GetCanonicalPath(filePath) + '\n' + std::to_string((int)options.Mipmaps);
+	return s_Textures.Get(key, [&filePath, &options]() { return new Texture(filePath, options); });
+}
+
+std::shared_ptr<Shader> ResourceCache::GetShader(const std::string& filePath, const std::vector<std::string>& defines, bool bAsync)
+{
+	std::vector<std::string> sortedDefines = defines;
+	std::sort(sortedDefines.begin(), sortedDefines.end());
+	sortedDefines.erase(std::unique(sortedDefines.begin(), sortedDefines.end()), sortedDefines.end());
+
+	// An asynchronous request can be served by a finished shader and vice versa, so bAsync is not part of the key
+	std::string key = GetCanonicalPath(filePath);
+	for (const std::string& define : sortedDefines)
+	{
+		// Neither a path nor a define can contain a line break
+		key += '\n';
+		key += define;
+	}
+
+	return s_Shaders.Get(key, [&filePath, &defines, bAsync]() { return new Shader(filePath, defines, bAsync); });
+}
+
+void ResourceCache::SetRetainedCount(unsigned int count)
+{
+	s_RetainedCount = count;
+	s_Textures.Trim();
+	s_Shaders.Trim();
+}
+
+void ResourceCache::Clear()
+{
+	s_Textures.Clear();
+	s_Shaders.Clear();
+}
+
+unsigned int ResourceCache::GetTextureCount()
+{
+	return s_Textures.GetLiveCount();
+}
+
+unsigned int ResourceCache::GetShaderCount()
+{
+	return s_Shaders.GetLiveCount();
+}
+
+const ResourceCache::Statistics& ResourceCache::GetStats()
+{
+	return s_Stats;
+}
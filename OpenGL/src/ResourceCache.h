@@ -0,0 +1,50 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+class Shader;
+
+/**
+ * Shares textures and shaders between their users.
+ * Requesting the same file with the same options returns the object already loaded as long as somebody still holds it.
+ * Once the last user lets go, the object is kept in a small LRU list for a while, so a scene which is closed and reopened does not load it again.
+ * Files are identified by their absolute path, "res/a.png" and "res/../res/a.png" refer to one entry.
+ * Must only be used on the thread owning the GL context, which is also where the returned objects have to be released.
+ */
+class ResourceCache
+{
+public:
+	struct Statistics
+	{
+		/** Requests served by an object somebody else was holding. */
+		unsigned int Hits = 0;
+		/** Requests served from the released list. */
+		unsigned int Revivals = 0;
+		/** Requests which had to load the file. */
+		unsigned int Loads = 0;
+		/** Released objects destroyed to make room in the LRU list. */
+		unsigned int Evictions = 0;
+	};
+
+public:
+	/** One file loaded with different mipmap modes yields separate textures. options.Anisotropy only applies when the texture is created. */
+	static std::shared_ptr<Texture> GetTexture(const std::string& filePath, const TextureOptions& options = TextureOptions());
+	/** The order of defines does not matter, see Shader for their format. */
+	static std::shared_ptr<Shader> GetShader(const std::string& filePath, const std::vector<std::string>& defines = std::vector<std::string>(), bool bAsync = false);
+
+	/** Number of released objects kept per resource type, the default is 16. Shrinking evicts right away. */
+	static void SetRetainedCount(unsigned int count);
+	/** Destroy all the released objects, MUST be called before the GL context goes away. */
+	static void Clear();
+
+	/** Objects currently held by somebody, per type. */
+	static unsigned int GetTextureCount();
+	static unsigned int GetShaderCount();
+
+	static const Statistics& GetStats();
+
+};
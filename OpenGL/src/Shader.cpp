@@ -1,69 +1,231 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <sstream>
 
+#include "AssetPack.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "UniformBuffer.h"
+#include "ProgramBinaryCache.h"
 
-Shader::Shader(const std::string& filePath)
+// Either extension lets the driver compile on its own threads and report completion without blocking
+static bool IsParallelCompileSupported()
+{
+	return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+}
+
+// Shaders are only created on the thread owning the GL context
+static unsigned int s_ShaderCount = 0;
+
+Shader::Shader(const std::string& filePath, bool bAsync)
+	: Shader(filePath, std::vector<std::string>(), bAsync)
+{
+}
+
+Shader::Shader(const std::string& filePath, const std::vector<std::string>& defines, bool bAsync)
 	: m_filePath(filePath)
 	, m_RendererID(0)
+	, m_bReady(false)
+	, m_PendingShaders{ 0, 0 }
+	, m_UniqueID(++s_ShaderCount)
 {
+	static bool s_bCompilerThreadsRequested = false;
+	if (bAsync && !s_bCompilerThreadsRequested && IsParallelCompileSupported())
+	{
+		// 0xFFFFFFFF lets the implementation pick the number of threads
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			GLCALL(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+		}
+		else
+		{
+			GLCALL(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+		}
+		s_bCompilerThreadsRequested = true;
+	}
+
 	std::string vsSource, fsSource;
-	ParseShader(filePath, vsSource, fsSource);
+	if (!ParseShader(filePath, defines, vsSource, fsSource))
+	{
+		// Same state as a program which failed to build, nothing is drawn with it
+		std::cout << "Failed to parse shader '" << filePath << "'!" << std::endl;
+		m_bReady = true;
+		return;
+	}
 	m_RendererID = CreateShader(vsSource, fsSource);
+	if (!bAsync)
+	{
+		FinishProgram();
+	}
 }
 
 Shader::~Shader()
 {
+	// Released before it finished building, the shader objects are still attached
+	for (unsigned int shader : m_PendingShaders)
+	{
+		if (shader != 0)
+		{
+			GLCALL(glDeleteShader(shader));
+		}
+	}
 	// Delete the program object
 	GLCALL(glDeleteProgram(m_RendererID));
+	GLStateCache::OnProgramDeleted(m_RendererID);
+}
+
+bool Shader::IsReady() const
+{
+	if (m_bReady)
+	{
+		return true;
+	}
+
+	if (IsParallelCompileSupported())
+	{
+		int bCompleted = GL_FALSE;
+		// Unlike any other status query this one never blocks
+		GLCALL(glGetProgramiv(m_RendererID, GL_COMPLETION_STATUS_KHR, &bCompleted));
+		if (bCompleted == GL_FALSE)
+		{
+			return false;
+		}
+	}
+
+	// Without the extension this waits, but only when the program is first needed
+	FinishProgram();
+	return true;
 }
 
 void Shader::Bind() const
 {
-	GLCALL(glUseProgram(m_RendererID));
+	GLStateCache::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-	GLCALL(glUseProgram(0));
+	GLStateCache::UseProgram(0);
+}
+
+UniformHandle Shader::GetUniformHandle(const UniformName& name) const
+{
+	return UniformHandle(GetUniformLocation(name));
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+const std::vector<ShaderUniform>& Shader::GetUniforms() const
+{
+	if (!m_bReady)
+	{
+		FinishProgram();
+	}
+	return m_Uniforms;
+}
+
+const std::vector<ShaderAttribute>& Shader::GetAttributes() const
+{
+	if (!m_bReady)
+	{
+		FinishProgram();
+	}
+	return m_Attributes;
+}
+
+const std::vector<ShaderUniformBlock>& Shader::GetUniformBlocks() const
+{
+	if (!m_bReady)
+	{
+		FinishProgram();
+	}
+	return m_UniformBlocks;
+}
+
+void Shader::SetUniform1i(const UniformName& name, int value)
 {
 	GLCALL(glUniform1i(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform1iv(const UniformName& name, int count, const int* values)
+{
+	GLCALL(glUniform1iv(GetUniformLocation(name), count, values));
+}
+
+void Shader::SetUniform4f(const UniformName& name, float v0, float v1, float v2, float v3)
 {
 	GLCALL(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniformMat4f(const UniformName& name, const glm::mat4& matrix)
 {
 	GLCALL(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
 }
 
-void Shader::ParseShader(const std::string& filePath, std::string& vertexShaderSource, std::string& fragmentShaderSource)
+void Shader::SetUniform1i(UniformHandle handle, int value)
 {
-	std::ifstream stream(filePath);
+	GLCALL(glUniform1i(handle.Location, value));
+}
 
-	enum class ShaderType
+void Shader::SetUniform1iv(UniformHandle handle, int count, const int* values)
+{
+	GLCALL(glUniform1iv(handle.Location, count, values));
+}
+
+void Shader::SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3)
+{
+	GLCALL(glUniform4f(handle.Location, v0, v1, v2, v3));
+}
+
+void Shader::SetUniformMat4f(UniformHandle handle, const glm::mat4& matrix)
+{
+	GLCALL(glUniformMatrix4fv(handle.Location, 1, GL_FALSE, &matrix[0][0]));
+}
+
+enum class ShaderType
+{
+	NONE = -1,
+	VERTEX = 0,
+	FRAGMENT = 1
+};
+
+// Include directives nested deeper than this are assumed to be a cycle
+static const unsigned int s_MaxIncludeDepth = 16;
+
+// Append the lines of a shader file to the stream of the stage they belong to, resolving #include "file" relative to the including file
+static bool AppendShaderSource(const std::string& filePath, ShaderType& type, std::stringstream* ss, std::vector<std::string>& includedFiles, unsigned int depth)
+{
+	// Straight from the asset pack if it is mounted, so only the lines themselves are copied
+	std::vector<unsigned char> storage;
+	const AssetView source = AssetPack::Read(filePath, storage);
+	if (!source.Data)
 	{
-		NONE = -1,
-		VERTEX = 0,
-		FRAGMENT = 1
-	};
+		std::cout << "Failed to open shader file '" << filePath << "'!" << std::endl;
+		return false;
+	}
+	// Every file is included at most once per stage, like #pragma once
+	includedFiles.push_back(filePath);
 
-	std::string line;
-	std::stringstream ss[2];
-	ShaderType type = ShaderType::NONE;
-	while (getline(stream, line))
+	const size_t slash = filePath.find_last_of("/\\");
+	const std::string directory = slash == std::string::npos ? "" : filePath.substr(0, slash + 1);
+
+	const char* const sourceEnd = (const char*)source.Data + source.Size;
+	for (const char* lineBegin = (const char*)source.Data; lineBegin < sourceEnd;)
 	{
-		if (line.find("#shader") != std::string::npos)
+		const char* newline = (const char*)memchr(lineBegin, '\n', sourceEnd - lineBegin);
+		const char* lineEnd = newline ? newline : sourceEnd;
+		const char* next = newline ? newline + 1 : sourceEnd;
+		if (lineEnd > lineBegin && lineEnd[-1] == '\r')
 		{
+			--lineEnd;
+		}
+		const size_t length = lineEnd - lineBegin;
+
+		// Only directives are worth a string, everything else is written out as is
+		static const char s_ShaderDirective[] = "#shader";
+		if (std::search(lineBegin, lineEnd, s_ShaderDirective, s_ShaderDirective + 7) != lineEnd)
+		{
+			const std::string line(lineBegin, length);
 			if (line.find("vertex") != std::string::npos)
 			{
 				type = ShaderType::VERTEX;
@@ -72,14 +234,77 @@ void Shader::ParseShader(const std::string& filePath, std::string& vertexShaderS
 			{
 				type = ShaderType::FRAGMENT;
 			}
+			// A new stage may include the same files again
+			includedFiles.clear();
 		}
-		else
+		else if (length >= 8 && memcmp(lineBegin, "#include", 8) == 0)
+		{
+			const std::string line(lineBegin, length);
+			const size_t begin = line.find('"');
+			const size_t end = line.find('"', begin + 1);
+			if (begin == std::string::npos || end == std::string::npos || depth >= s_MaxIncludeDepth)
+			{
+				std::cout << "Invalid #include in '" << filePath << "': " << line << std::endl;
+				return false;
+			}
+			const std::string includePath = directory + line.substr(begin + 1, end - begin - 1);
+			if (std::find(includedFiles.begin(), includedFiles.end(), includePath) == includedFiles.end()
+				&& !AppendShaderSource(includePath, type, ss, includedFiles, depth + 1))
+			{
+				return false;
+			}
+		}
+		else if (type != ShaderType::NONE)
 		{
-			ss[(int)type] << line << "\n";
+			ss[(int)type].write(lineBegin, length);
+			ss[(int)type] << "\n";
 		}
+		lineBegin = next;
+	}
+	return true;
+}
+
+// Defines have to come after #version, which must be the first statement of a shader
+static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+	if (defines.empty())
+	{
+		return source;
+	}
+
+	std::string defineBlock;
+	for (const std::string& define : defines)
+	{
+		defineBlock += "#define " + define + "\n";
+	}
+
+	const size_t version = source.find("#version");
+	if (version == std::string::npos)
+	{
+		return defineBlock + source;
+	}
+	const size_t newline = source.find('\n', version);
+	if (newline == std::string::npos)
+	{
+		// #version is the last line
+		return source + "\n" + defineBlock;
+	}
+	return source.substr(0, newline + 1) + defineBlock + source.substr(newline + 1);
+}
+
+bool Shader::ParseShader(const std::string& filePath, const std::vector<std::string>& defines, std::string& vertexShaderSource, std::string& fragmentShaderSource)
+{
+	std::stringstream ss[2];
+	ShaderType type = ShaderType::NONE;
+	std::vector<std::string> includedFiles;
+	if (!AppendShaderSource(filePath, type, ss, includedFiles, 0))
+	{
+		return false;
 	}
-	vertexShaderSource = ss[0].str();
-	fragmentShaderSource = ss[1].str();
+
+	vertexShaderSource = InjectDefines(ss[0].str(), defines);
+	fragmentShaderSource = InjectDefines(ss[1].str(), defines);
+	return true;
 }
 
 int Shader::CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
@@ -87,29 +312,146 @@ int Shader::CreateShader(const std::string& vertexShaderSource, const std::strin
 	// Create the program object
 	GLCALL(unsigned int program = glCreateProgram());
 
-	unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-	unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+	m_CacheKey = ProgramBinaryCache::MakeKey(vertexShaderSource, fragmentShaderSource);
+	if (ProgramBinaryCache::Load(program, m_CacheKey))
+	{
+		// Nothing to wait for and nothing to store
+		m_CacheKey.clear();
+		return program;
+	}
+
+	// Nothing below queries a result, so the driver is free to compile and link in the background
+	m_PendingShaders[0] = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
+	m_PendingShaders[1] = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
 
 	// Attach shaders to the program object
-	GLCALL(glAttachShader(program, vs));
-	GLCALL(glAttachShader(program, fs));
+	GLCALL(glAttachShader(program, m_PendingShaders[0]));
+	GLCALL(glAttachShader(program, m_PendingShaders[1]));
+	if (ProgramBinaryCache::IsSupported())
+	{
+		GLCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+	}
 	// Link the program
 	GLCALL(glLinkProgram(program));
-	// Check to see whether the executables contained in program can execute given the current OpenGL state.
-	GLCALL(glValidateProgram(program));
 
-	GLCALL(glDeleteShader(vs));
-	GLCALL(glDeleteShader(fs));
+	return program;
+}
+
+void Shader::FinishProgram() const
+{
+	m_bReady = true;
+
+	bool bCompiled = true;
+	for (int i = 0; i < 2; ++i)
+	{
+		if (m_PendingShaders[i] != 0)
+		{
+			bCompiled &= CheckCompileStatus(m_PendingShaders[i], i == 0 ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER);
+			GLCALL(glDeleteShader(m_PendingShaders[i]));
+			m_PendingShaders[i] = 0;
+		}
+	}
+
+	// Linking and loading a binary both reset block bindings
+	BindUniformBlocks(m_RendererID);
+	// Check to see whether the executables contained in program can execute given the current OpenGL state.
+	GLCALL(glValidateProgram(m_RendererID));
 
 	int result;
-	GLCALL(glGetProgramiv(program, GL_VALIDATE_STATUS, &result));
-	if (result == GL_FALSE)
+	GLCALL(glGetProgramiv(m_RendererID, GL_VALIDATE_STATUS, &result));
+	if (!bCompiled || result == GL_FALSE)
 	{
 		std::cout << "Failed to validate program!" << std::endl;
-		return 0;
+		GLCALL(glDeleteProgram(m_RendererID));
+		m_RendererID = 0;
+		return;
 	}
 
-	return program;
+	Reflect();
+
+	if (!m_CacheKey.empty())
+	{
+		ProgramBinaryCache::Save(m_RendererID, m_CacheKey);
+	}
+}
+
+void Shader::Reflect() const
+{
+	int count = 0;
+	int maxLength = 0;
+
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+	std::vector<char> name(maxLength + 1);
+	for (int i = 0; i < count; ++i)
+	{
+		ShaderUniform uniform;
+		int length = 0;
+		GLCALL(glGetActiveUniform(m_RendererID, i, (int)name.size(), &length, &uniform.Size, &uniform.Type, name.data()));
+		GLCALL(uniform.Location = glGetUniformLocation(m_RendererID, name.data()));
+		// Members of uniform blocks have no location, they are set through UniformBuffer
+		if (uniform.Location == -1)
+		{
+			continue;
+		}
+
+		uniform.Name.assign(name.data(), length);
+		// Arrays are reported as "name[0]" but usually looked up by their plain name, accept both
+		if (uniform.Name.size() > 3 && uniform.Name.compare(uniform.Name.size() - 3, 3, "[0]") == 0)
+		{
+			m_uniformLocationCache.emplace(HashUniformName(uniform.Name.c_str()), UniformCacheEntry{ uniform.Location, uniform.Name });
+			uniform.Name.resize(uniform.Name.size() - 3);
+		}
+		m_uniformLocationCache.emplace(HashUniformName(uniform.Name.c_str()), UniformCacheEntry{ uniform.Location, uniform.Name });
+		m_Uniforms.push_back(uniform);
+	}
+
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTES, &count));
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+	name.resize(maxLength + 1);
+	for (int i = 0; i < count; ++i)
+	{
+		ShaderAttribute attribute;
+		int length = 0;
+		GLCALL(glGetActiveAttrib(m_RendererID, i, (int)name.size(), &length, &attribute.Size, &attribute.Type, name.data()));
+		GLCALL(attribute.Location = glGetAttribLocation(m_RendererID, name.data()));
+		// Built-in inputs such as gl_VertexID are not fed from buffers
+		if (attribute.Location == -1)
+		{
+			continue;
+		}
+		attribute.Name.assign(name.data(), length);
+		m_Attributes.push_back(attribute);
+	}
+	std::sort(m_Attributes.begin(), m_Attributes.end(), [](const ShaderAttribute& a, const ShaderAttribute& b) { return a.Location < b.Location; });
+
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+	GLCALL(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+	name.resize(maxLength + 1);
+	for (int i = 0; i < count; ++i)
+	{
+		ShaderUniformBlock block;
+		int length = 0;
+		block.Index = i;
+		GLCALL(glGetActiveUniformBlockName(m_RendererID, i, (int)name.size(), &length, name.data()));
+		GLCALL(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.DataSize));
+		GLCALL(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_BINDING, &block.Binding));
+		block.Name.assign(name.data(), length);
+		m_UniformBlocks.push_back(block);
+	}
+}
+
+void Shader::BindUniformBlocks(unsigned int program) const
+{
+	for (unsigned int binding = 0; binding < UniformBlockBindingCount; ++binding)
+	{
+		GLCALL(unsigned int blockIndex = glGetUniformBlockIndex(program, UniformBlockNames[binding]));
+		// Blocks the program does not declare, or which are optimized out, are simply absent
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			GLCALL(glUniformBlockBinding(program, blockIndex, binding));
+		}
+	}
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -123,6 +465,11 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 	// Compile the shader object
 	GLCALL(glCompileShader(id));
 
+	return id;
+}
+
+bool Shader::CheckCompileStatus(unsigned int id, unsigned int type) const
+{
 	int result;
 	GLCALL(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
 	if (result == GL_FALSE)
@@ -135,26 +482,34 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 		GLCALL(glGetShaderInfoLog(id, length, &length, message));
 		std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragmemt") << " shader!" << std::endl;
 		std::cout << message << std::endl;
-		GLCALL(glDeleteShader(id));
-		return 0;
+		return false;
 	}
 
-	return id;
+	return true;
 }
 
-int Shader::GetUniformLocation(const std::string& name) const
+int Shader::GetUniformLocation(const UniformName& name) const
 {
-	if (m_uniformLocationCache.find(name) != m_uniformLocationCache.end())
+	// One lookup for both the hit and the miss
+	auto it = m_uniformLocationCache.find(name.Hash);
+	if (it != m_uniformLocationCache.end())
 	{
-		return m_uniformLocationCache[name];
+#ifdef DEBUG
+		// Two uniforms of one program hashing to the same value would silently alias
+		ASSERT(it->second.Name == name.Name);
+#endif
+		return it->second.Location;
 	}
 
-	GLCALL(unsigned int location = glGetUniformLocation(m_RendererID, name.c_str()));
-	// If "name" is not used in the fragment shader, it will return -1
-	if (location == -1)
+	// Every active uniform was cached by Reflect(), the program only has to be finished
+	if (!m_bReady)
 	{
-		std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+		FinishProgram();
+		return GetUniformLocation(name);
 	}
-	m_uniformLocationCache[name] = location;
-	return location;
+
+	// Not declared, or not used and optimized out. Cached as well so the warning is printed once
+	std::cout << "Warning: uniform '" << name.Name << "' doesn't exist!" << std::endl;
+	m_uniformLocationCache.emplace(name.Hash, UniformCacheEntry{ -1, name.Name });
+	return -1;
 }
@@ -2,37 +2,174 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
 
+/** 32-bit FNV-1a, usable at compile time. */
+constexpr unsigned int HashUniformName(const char* name)
+{
+	unsigned int hash = 2166136261u;
+	while (*name)
+	{
+		hash = (hash ^ (unsigned char)*name++) * 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Uniform name with its precomputed hash, string literals convert implicitly so SetUniform*("u_Name", ...) still works.
+ * Declare it constexpr(or static) to make sure the hash is computed at compile time.
+ * The name is not copied, it only has to outlive the call.
+ */
+struct UniformName
+{
+	const char* Name;
+	unsigned int Hash;
+
+	constexpr UniformName(const char* name)
+		: Name(name)
+		, Hash(HashUniformName(name))
+	{
+	}
+	UniformName(const std::string& name)
+		: Name(name.c_str())
+		, Hash(HashUniformName(name.c_str()))
+	{
+	}
+};
+
+/** Location of a uniform in one specific program, resolved once with Shader::GetUniformHandle() so that setting it needs no lookup at all. */
+struct UniformHandle
+{
+	int Location;
+
+	UniformHandle()
+		: Location(-1)
+	{
+	}
+	explicit UniformHandle(int location)
+		: Location(location)
+	{
+	}
+
+	inline bool IsValid() const { return Location != -1; }
+};
+
+/** Active uniform of a linked program, arrays are listed once with their element count as Size. */
+struct ShaderUniform
+{
+	std::string Name;
+	int Location;
+	/** GL type enum, e.g. GL_FLOAT_MAT4 or GL_SAMPLER_2D. */
+	unsigned int Type;
+	int Size;
+};
+
+/** Active vertex input of a linked program, matrices occupy one location per column. */
+struct ShaderAttribute
+{
+	std::string Name;
+	int Location;
+	unsigned int Type;
+	int Size;
+};
+
+/** Active uniform block of a linked program. */
+struct ShaderUniformBlock
+{
+	std::string Name;
+	unsigned int Index;
+	int DataSize;
+	int Binding;
+};
+
 class Shader
 {
 public:
-	Shader(const std::string& filePath);
+	/**
+	 * @param bAsync - Only submit compiling and linking, the program can not be used before IsReady() returns true.
+	 * With KHR/ARB_parallel_shader_compile the driver builds it on its own threads, so many shaders can be created without waiting on each other.
+	 */
+	Shader(const std::string& filePath, bool bAsync = false);
+	/** Build a variant of the shader, every entry is injected as "#define <entry>" right after #version, e.g. "USE_TINT" or "MAX_LIGHTS 4". */
+	Shader(const std::string& filePath, const std::vector<std::string>& defines, bool bAsync = false);
 	~Shader();
 
+	/** Whether the program has finished building, never blocks when parallel compilation is supported. Renderer skips draws until then. */
+	bool IsReady() const;
+
 	/** Install(bind) the program object as part of current rendering state. */
 	void Bind() const;
 	/** Uninstall(unbind) program objects. */
 	void Unbind() const;
 
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	/** Never reused, unlike program names which GL hands out again once a program is deleted. */
+	inline unsigned int GetUniqueID() const { return m_UniqueID; }
+
+	/** Resolve a uniform once, the handle stays valid for the lifetime of this shader. */
+	UniformHandle GetUniformHandle(const UniformName& name) const;
+
+	/**
+	 * Reflection of the linked program, gathered once when it is finished.
+	 * These wait for an asynchronous build, so call them after IsReady() to avoid stalling.
+	 */
+	const std::vector<ShaderUniform>& GetUniforms() const;
+	/** Sorted by location. */
+	const std::vector<ShaderAttribute>& GetAttributes() const;
+	const std::vector<ShaderUniformBlock>& GetUniformBlocks() const;
+
+	void SetUniform1i(const UniformName& name, int value);
+	void SetUniform1iv(const UniformName& name, int count, const int* values);
+	void SetUniform4f(const UniformName& name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(const UniformName& name, const glm::mat4& matrix);
+
+	void SetUniform1i(UniformHandle handle, int value);
+	void SetUniform1iv(UniformHandle handle, int count, const int* values);
+	void SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(UniformHandle handle, const glm::mat4& matrix);
 
 private:
-	/** Read shaders from shader file. */
-	void ParseShader(const std::string& filePath, std::string& vertexShaderSource, std::string& fragmentShaderSource);
+	/** Read shaders from shader file, resolving #include "file" directives relative to the including file. False if a file is missing or includes nest too deep. */
+	bool ParseShader(const std::string& filePath, const std::vector<std::string>& defines, std::string& vertexShaderSource, std::string& fragmentShaderSource);
+	/** Submit compiling and linking, results are only queried by FinishProgram() so that the driver can work in the background. */
 	int CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
+	/** Print the info log of a shader object which failed to compile. */
+	bool CheckCompileStatus(unsigned int id, unsigned int type) const;
+	/** Check the build results, set up uniform blocks and store the binary in the cache. */
+	void FinishProgram() const;
+	/** Fill the reflection tables and the uniform location cache, after which uniform lookups never query GL. */
+	void Reflect() const;
+	/** Point the uniform blocks shared by all shaders(see UniformBlockBinding) at their fixed binding points. */
+	void BindUniformBlocks(unsigned int program) const;
 
-	int GetUniformLocation(const std::string& name) const;
+	int GetUniformLocation(const UniformName& name) const;
 
 private:
-	unsigned int m_RendererID;
+	/** Reset to 0 if the program fails to build, which an asynchronous build only reveals in IsReady(). */
+	mutable unsigned int m_RendererID;
+	mutable bool m_bReady;
+	/** Vertex and fragment shader objects until the program is finished. */
+	mutable unsigned int m_PendingShaders[2];
+	const unsigned int m_UniqueID;
+	/** Program binary cache entry to fill once the program is finished, empty if it was loaded from the cache. */
+	std::string m_CacheKey;
 
 	std::string m_filePath;
 
-	mutable std::unordered_map<std::string, int> m_uniformLocationCache;
+	struct UniformCacheEntry
+	{
+		int Location;
+		/** Kept to detect hash collisions in debug builds. */
+		std::string Name;
+	};
+	mutable std::vector<ShaderUniform> m_Uniforms;
+	mutable std::vector<ShaderAttribute> m_Attributes;
+	mutable std::vector<ShaderUniformBlock> m_UniformBlocks;
+
+	/** Keyed by name hash, so lookups never hash or copy strings. Filled from the reflection table. */
+	mutable std::unordered_map<unsigned int, UniformCacheEntry> m_uniformLocationCache;
 
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstring>
+#include <tuple>
+
+#include "glm/glm.hpp"
+
+/**
+ * Base alignment and size of GLSL types under the std140 rules, in bytes.
+ * Only types whose std140 representation matches the C++ one are described, arrays and mat3 need padding per element and are left out.
+ */
+template<typename T>
+struct Std140Traits;
+
+template<>
+struct Std140Traits<float> { static const unsigned int Alignment = 4; static const unsigned int Size = 4; };
+template<>
+struct Std140Traits<int> { static const unsigned int Alignment = 4; static const unsigned int Size = 4; };
+template<>
+struct Std140Traits<unsigned int> { static const unsigned int Alignment = 4; static const unsigned int Size = 4; };
+template<>
+struct Std140Traits<glm::vec2> { static const unsigned int Alignment = 8; static const unsigned int Size = 8; };
+/** A vec3 is aligned like a vec4, a following scalar may still fill its last 4 bytes. */
+template<>
+struct Std140Traits<glm::vec3> { static const unsigned int Alignment = 16; static const unsigned int Size = 12; };
+template<>
+struct Std140Traits<glm::vec4> { static const unsigned int Alignment = 16; static const unsigned int Size = 16; };
+/** Four vec4 columns. */
+template<>
+struct Std140Traits<glm::mat4> { static const unsigned int Alignment = 16; static const unsigned int Size = 64; };
+
+/**
+ * Compile-time description of a std140 uniform block, members are listed in declaration order.
+ * e.g. Std140Layout<glm::mat4, glm::vec3, float> describes
+ * layout(std140) uniform Block { mat4 a; vec3 b; float c; }; with offsets 0, 64, 76 and a size of 80.
+ */
+template<typename... Members>
+struct Std140Layout
+{
+	static const unsigned int MemberCount = sizeof...(Members);
+
+	template<unsigned int Index>
+	using MemberType = typename std::tuple_element<Index, std::tuple<Members...>>::type;
+
+	/** Byte offset of member index inside the block. */
+	static constexpr unsigned int GetOffset(unsigned int index)
+	{
+		const unsigned int alignments[] = { Std140Traits<Members>::Alignment... };
+		const unsigned int sizes[] = { Std140Traits<Members>::Size... };
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < index; ++i)
+		{
+			offset = RoundUp(offset, alignments[i]) + sizes[i];
+		}
+		return RoundUp(offset, alignments[index]);
+	}
+
+	/** Size of the whole block, rounded up to a multiple of a vec4 as the block would be inside an array. */
+	static constexpr unsigned int GetSize()
+	{
+		return RoundUp(GetOffset(MemberCount - 1) + Std140Traits<MemberType<MemberCount - 1>>::Size, 16);
+	}
+
+	/** Write member Index into block, which must point to at least GetSize() bytes. */
+	template<unsigned int Index>
+	static void Write(void* block, const MemberType<Index>& value)
+	{
+		memcpy((unsigned char*)block + GetOffset(Index), &value, Std140Traits<MemberType<Index>>::Size);
+	}
+
+private:
+	static constexpr unsigned int RoundUp(unsigned int value, unsigned int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+};
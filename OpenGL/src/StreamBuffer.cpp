@@ -0,0 +1,135 @@
+#include "StreamBuffer.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount)
+	: m_RendererID(0)
+	, m_Target(target)
+	, m_RegionSize(regionSize)
+	, m_RegionCount(regionCount)
+	, m_bPersistent(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+	, m_CurrentRegion(0)
+	, m_RegionOffset(0)
+	, m_Fences(regionCount, nullptr)
+	, m_MappedData(nullptr)
+	, m_StallCount(0)
+{
+	GLCALL(glGenBuffers(1, &m_RendererID));
+	Bind();
+	if (m_bPersistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		// Immutable storage is required for persistent mapping
+		GLCALL(glBufferStorage(m_Target, regionSize * regionCount, nullptr, flags));
+		GLCALL(m_MappedData = (unsigned char*)glMapBufferRange(m_Target, 0, regionSize * regionCount, flags));
+	}
+	else
+	{
+		// Orphaning gives us a fresh data store every frame, so one region is enough on the GPU side
+		m_RegionCount = 1;
+		m_StagingData.reset(new unsigned char[regionSize]);
+		m_MappedData = m_StagingData.get();
+		GLCALL(glBufferData(m_Target, regionSize, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (GLsync fence : m_Fences)
+	{
+		if (fence)
+		{
+			GLCALL(glDeleteSync(fence));
+		}
+	}
+
+	// Deleting a buffer unmaps it implicitly
+	GLCALL(glDeleteBuffers(1, &m_RendererID));
+	GLStateCache::OnBufferDeleted(m_RendererID);
+}
+
+void StreamBuffer::BeginFrame()
+{
+	m_RegionOffset = 0;
+
+	if (!m_bPersistent)
+	{
+		Bind();
+		// Orphan the old data store, the driver keeps it alive until the GPU is done with it
+		GLCALL(glBufferData(m_Target, m_RegionSize, nullptr, GL_STREAM_DRAW));
+		return;
+	}
+
+	GLsync& fence = m_Fences[m_CurrentRegion];
+	if (!fence)
+	{
+		return;
+	}
+
+	// Flush on the first try in case the fence has not been submitted to the GPU yet
+	GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	bool bStalled = false;
+	while (true)
+	{
+		GLCALL(GLenum result = glClientWaitSync(fence, waitFlags, 1000000/*1ms*/));
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+		{
+			break;
+		}
+		bStalled = true;
+		waitFlags = 0;
+	}
+	if (bStalled)
+	{
+		++m_StallCount;
+	}
+
+	GLCALL(glDeleteSync(fence));
+	fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (m_bPersistent)
+	{
+		// Signaled once the GPU has executed every command issued so far, i.e. all the draws reading this region
+		GLCALL(m_Fences[m_CurrentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	}
+	m_CurrentRegion = (m_CurrentRegion + 1) % m_RegionCount;
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(unsigned int size, unsigned int alignment)
+{
+	unsigned int offset = (m_RegionOffset + alignment - 1) / alignment * alignment;
+	if (offset + size > m_RegionSize)
+	{
+		return { nullptr, 0, 0 };
+	}
+	m_RegionOffset = offset + size;
+
+	const unsigned int regionStart = m_bPersistent ? m_CurrentRegion * m_RegionSize : 0;
+	return { m_MappedData + regionStart + offset, regionStart + offset, size };
+}
+
+void StreamBuffer::Flush(const Allocation& allocation)
+{
+	// Coherent mapping makes writes visible without any call
+	if (m_bPersistent || !allocation.Data)
+	{
+		return;
+	}
+
+	Bind();
+	GLCALL(glBufferSubData(m_Target, allocation.Offset, allocation.Size, allocation.Data));
+}
+
+void StreamBuffer::Bind() const
+{
+	GLStateCache::BindBuffer(m_Target, m_RendererID);
+}
+
+void StreamBuffer::Unbind() const
+{
+	GLStateCache::BindBuffer(m_Target, 0);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+/**
+ * Ring buffer for geometry that is respecified every frame.
+ * The buffer is split into regionCount regions, each frame writes into its own region and fences it at EndFrame(),
+ * the region is only written again after the GPU signaled that fence, so writing never stalls on the GPU reading.
+ * With GL 4.4/ARB_buffer_storage the buffer is mapped once persistently and coherently, writes go straight to GPU visible memory.
+ * Otherwise writes go to a CPU staging copy and are uploaded by Flush() into a buffer orphaned every frame.
+ */
+class StreamBuffer
+{
+public:
+	struct Allocation
+	{
+		/** Write pointer, null if the region has no room left. */
+		void* Data;
+		/** Offset from the start of the GL buffer, in bytes. */
+		unsigned int Offset;
+		unsigned int Size;
+	};
+
+public:
+	/**
+	 * @param target - GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER...
+	 * @param regionSize - Bytes which can be allocated per frame
+	 * @param regionCount - Frames the CPU can be ahead of the GPU, 3 for triple buffering
+	 */
+	StreamBuffer(unsigned int target, unsigned int regionSize, unsigned int regionCount = 3);
+	~StreamBuffer();
+
+	/** Wait until the GPU has finished reading current region. */
+	void BeginFrame();
+	/** Fence current region and move to the next one, can be called early if the region is full and the pending draws have been issued. */
+	void EndFrame();
+
+	/** Reserve size bytes in current region, offset is rounded up to a multiple of alignment. */
+	Allocation Allocate(unsigned int size, unsigned int alignment = 4);
+	/** Make the written allocation visible to GL, MUST be called before drawing from it. */
+	void Flush(const Allocation& allocation);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsPersistentlyMapped() const { return m_bPersistent; }
+	/** How many times BeginFrame() had to block on a fence. */
+	inline unsigned int GetStallCount() const { return m_StallCount; }
+
+	void Bind() const;
+	void Unbind() const;
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	bool m_bPersistent;
+
+	unsigned int m_CurrentRegion;
+	/** Bytes allocated in current region. */
+	unsigned int m_RegionOffset;
+	std::vector<GLsync> m_Fences;
+
+	/** Start of the persistent mapping, or the staging copy of one region when falling back to orphaning. */
+	unsigned char* m_MappedData;
+	std::unique_ptr<unsigned char[]> m_StagingData;
+
+	unsigned int m_StallCount;
+
+};
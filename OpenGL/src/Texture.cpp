@@ -1,38 +1,66 @@
 #include "Texture.h"
 
+#include <algorithm>
+#include <iostream>
+
+#include "AssetPack.h"
+#include "GLStateCache.h"
+#include "MipmapGenerator.h"
+
 #include "stb_image/stb_image.h"
 
-Texture::Texture(const std::string& filePath)
+Texture::Texture(const std::string& filePath, const TextureOptions& options)
 	: m_RendererID(0)
+	, m_bLoaded(true)
 	, m_FilePath(filePath)
 	, m_LocalBuffer(nullptr)
 	, m_Width(0)
 	, m_Height(0)
 	, m_BPP(0)
+	, m_MemorySize(0)
 {
-	// OpenGL expects the texture pixels to start at the bottom-left(0,0) instead of the top-left
-	// Typically, when png image is being loaded, it is stored in scanlines from the top to the bottom of the image, so we need to flip it on load
-	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(filePath.c_str(), &m_Width, &m_Height, &m_BPP, 4/*RGBA*/);
-
 	// Generate texture names
 	GLCALL(glGenTextures(1, &m_RendererID));
 	
-	GLCALL(glActiveTexture(GL_TEXTURE0));
 	// Bind
-	GLCALL(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_RendererID);
 
-	// Set texture parameters
-	// This is the minification filter that how the texture will be resampled down if it needs to be rendered smaller per pixel
-	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	if (DDSFile::IsDDSFile(filePath))
+	{
+		// Blocks go to the GPU as they are, there is nothing to decode
+		CompressedImage image;
+		if (DDSFile::Load(filePath, image))
+		{
+			if (IsCompressedFormatSupported(image.Format))
+			{
+				m_Width = image.Width;
+				m_Height = image.Height;
+				m_MemorySize = UploadCompressed(image.Data.data(), image, options);
+			}
+			else
+			{
+				std::cout << "Compressed format of '" << filePath << "' is not supported by the driver!" << std::endl;
+			}
+		}
+	}
+	else
+	{
+		// OpenGL expects the texture pixels to start at the bottom-left(0,0) instead of the top-left
+		// Typically, when png image is being loaded, it is stored in scanlines from the top to the bottom of the image, so Application makes stb_image flip it on load
+		m_LocalBuffer = AssetPack::DecodeImage(filePath, m_Width, m_Height, m_BPP);
 
-	// Send OpenGL the texture data
-	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8/*8-bits per channel*/, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+		if (m_LocalBuffer && options.Mipmaps == MipmapMode::CPU)
+		{
+			const std::vector<unsigned char> chain = MipmapGenerator::BuildChain(m_LocalBuffer, m_Width, m_Height);
+			m_MemorySize = Upload(chain.data(), m_Width, m_Height, options);
+		}
+		else
+		{
+			m_MemorySize = Upload(m_LocalBuffer, m_Width, m_Height, options);
+		}
+	}
 	// Unbind
-	GLCALL(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
 
 	if (m_LocalBuffer)
 	{
@@ -41,20 +69,165 @@ Texture::Texture(const std::string& filePath)
 	}
 }
 
+Texture::Texture(const unsigned char* pixels, int width, int height, const TextureOptions& options)
+	: m_RendererID(0)
+	, m_bLoaded(true)
+	, m_LocalBuffer(nullptr)
+	, m_Width(width)
+	, m_Height(height)
+	, m_BPP(4)
+	, m_MemorySize(0)
+{
+	GLCALL(glGenTextures(1, &m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_RendererID);
+	if (options.Mipmaps == MipmapMode::CPU)
+	{
+		const std::vector<unsigned char> chain = MipmapGenerator::BuildChain(pixels, width, height);
+		m_MemorySize = Upload(chain.data(), width, height, options);
+	}
+	else
+	{
+		m_MemorySize = Upload(pixels, width, height, options);
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+}
+
+Texture::Texture(const std::string& filePath, unsigned int placeholder)
+	: m_RendererID(placeholder)
+	, m_bLoaded(false)
+	, m_FilePath(filePath)
+	, m_LocalBuffer(nullptr)
+	, m_Width(0)
+	, m_Height(0)
+	, m_BPP(4)
+	, m_MemorySize(0)
+{
+}
+
 Texture::~Texture()
 {
-	// Delete named textures
-	GLCALL(glDeleteTextures(1, &m_RendererID));
+	if (m_bLoaded)
+	{
+		// Delete named textures
+		GLCALL(glDeleteTextures(1, &m_RendererID));
+		GLStateCache::OnTextureDeleted(m_RendererID);
+	}
+}
+
+void Texture::OnLoaded(unsigned int rendererID, int width, int height, unsigned int memorySize)
+{
+	m_RendererID = rendererID;
+	m_bLoaded = true;
+	m_Width = width;
+	m_Height = height;
+	m_MemorySize = memorySize;
+}
+
+float Texture::GetMaxAnisotropy()
+{
+	static float s_MaxAnisotropy = 0.f;
+	if (s_MaxAnisotropy == 0.f)
+	{
+		s_MaxAnisotropy = 1.f;
+		if (GLEW_EXT_texture_filter_anisotropic)
+		{
+			GLCALL(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &s_MaxAnisotropy));
+		}
+	}
+	return s_MaxAnisotropy;
+}
+
+bool Texture::IsCompressedFormatSupported(unsigned int format)
+{
+	switch (format)
+	{
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		return GLEW_EXT_texture_compression_s3tc;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	default:
+		return false;
+	}
+}
+
+void Texture::SetParameters(const TextureOptions& options, bool bMipmapped, unsigned int target)
+{
+	// Set texture parameters
+	// This is the minification filter that how the texture will be resampled down if it needs to be rendered smaller per pixel
+	// With mipmaps it blends the two nearest levels, sampling each bilinearly
+	GLCALL(glTexParameteri(target, GL_TEXTURE_MIN_FILTER, bMipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCALL(glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCALL(glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	if (options.Anisotropy > 1.f && GLEW_EXT_texture_filter_anisotropic)
+	{
+		GLCALL(glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(options.Anisotropy, GetMaxAnisotropy())));
+	}
+}
+
+unsigned int Texture::Upload(const unsigned char* data, int width, int height, const TextureOptions& options)
+{
+	SetParameters(options, options.Mipmaps != MipmapMode::None);
+	const unsigned int memorySize = (unsigned int)(options.Mipmaps == MipmapMode::None ? (size_t)width * height * 4 : MipmapGenerator::GetChainSize(width, height));
+
+	// Send OpenGL the texture data
+	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8/*8-bits per channel*/, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+
+	if (options.Mipmaps == MipmapMode::GPU && width > 0 && height > 0)
+	{
+		GLCALL(glGenerateMipmap(GL_TEXTURE_2D));
+	}
+	else if (options.Mipmaps == MipmapMode::CPU)
+	{
+		const unsigned int levels = MipmapGenerator::GetLevelCount(width, height);
+		for (unsigned int level = 1; level < levels; ++level)
+		{
+			data += (size_t)width * height * 4;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			GLCALL(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+		}
+	}
+	return memorySize;
+}
+
+unsigned int Texture::UploadCompressed(const unsigned char* data, const CompressedImage& image, const TextureOptions& options)
+{
+	unsigned int memorySize = 0;
+	SetParameters(options, image.Levels.size() > 1);
+	// Files do not have to carry the chain down to 1x1
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)image.Levels.size() - 1));
+
+	for (unsigned int level = 0; level < image.Levels.size(); ++level)
+	{
+		const CompressedImage::Level& levelInfo = image.Levels[level];
+		GLCALL(glCompressedTexImage2D(GL_TEXTURE_2D, level, image.Format, levelInfo.Width, levelInfo.Height, 0, levelInfo.Size, data + levelInfo.Offset));
+		memorySize += levelInfo.Size;
+	}
+	return memorySize;
+}
+
+void Texture::SetAnisotropy(float anisotropy)
+{
+	// The placeholder is shared by every texture being loaded
+	if (!m_bLoaded || !GLEW_EXT_texture_filter_anisotropic)
+	{
+		return;
+	}
+
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_RendererID);
+	GLCALL(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::max(1.f, std::min(anisotropy, GetMaxAnisotropy()))));
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	// Select active texture unit(slot)
-	GLCALL(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCALL(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	// Select active texture unit(slot) and bind, both are skipped if nothing changes
+	GLStateCache::BindTexture(GL_TEXTURE_2D, slot, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
-	GLCALL(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, GLStateCache::GetActiveTextureSlot(), 0);
 }
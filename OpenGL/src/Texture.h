@@ -3,25 +3,85 @@
 #include <string>
 
 #include "Renderer.h"
+#include "DDSFile.h"
+
+/** How the mip chain of a texture is built. */
+enum class MipmapMode
+{
+	/** Level 0 only, minified textures alias. */
+	None,
+	/** glGenerateMipmap after uploading level 0, the filter is up to the driver. */
+	GPU,
+	/** 2x2 box filter on the CPU(see MipmapGenerator) and every level is uploaded, identical on all drivers. */
+	CPU
+};
+
+struct TextureOptions
+{
+	MipmapMode Mipmaps = MipmapMode::GPU;
+	/** Samples along the axis of anisotropy, 1 disables it. Clamped to GetMaxAnisotropy(). */
+	float Anisotropy = 1.f;
+};
 
 class Texture
 {
 public:
-	Texture(const std::string& filePath);
+	/**
+	 * Load a PNG(or anything else stb_image reads), or a block-compressed ".dds" file(see DDSFile).
+	 * Compressed textures keep the levels stored in the file, options.Mipmaps does not apply to them.
+	 */
+	Texture(const std::string& filePath, const TextureOptions& options = TextureOptions());
+	/** Create from tightly packed RGBA8 pixels, the first row is the bottom one. */
+	Texture(const unsigned char* pixels, int width, int height, const TextureOptions& options = TextureOptions());
 	~Texture();
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	/** False while a TextureLoader is still streaming the image in, the texture shows a placeholder meanwhile. */
+	inline bool IsLoaded() const { return m_bLoaded; }
+	/** Bytes of GPU memory taken by all levels, as uploaded(compressed textures count their blocks). */
+	inline unsigned int GetMemorySize() const { return m_MemorySize; }
+
+	/** Highest anisotropy the driver supports, 1 without EXT_texture_filter_anisotropic. Queried once, so the first call must be made on the thread owning the GL context. */
+	static float GetMaxAnisotropy();
+	/** Whether the driver can sample a compressed format, BC1/BC3 need EXT_texture_compression_s3tc, BC7 needs GL 4.2 or ARB_texture_compression_bptc. */
+	static bool IsCompressedFormatSupported(unsigned int format);
+
+	/** Change the anisotropy of this texture, clamped to 1..GetMaxAnisotropy(). Ignored while a TextureLoader is still streaming it in. */
+	void SetAnisotropy(float anisotropy);
 
 	/** Bind a named texture to a texturing target with the specified slot. */
 	void Bind(unsigned int slot = 0) const;
 	/** Unbind textures from a texturing target. */
 	void Unbind() const;
 
+private:
+	friend class TextureLoader;
+	friend class TextureArray;
+
+	/** Texture showing placeholder until TextureLoader hands over the real one. */
+	Texture(const std::string& filePath, unsigned int placeholder);
+	/** Take ownership of the uploaded texture object. */
+	void OnLoaded(unsigned int rendererID, int width, int height, unsigned int memorySize);
+	/**
+	 * Set the sampling state and fill the texture bound to GL_TEXTURE_2D.
+	 * @param data - Level 0, or with MipmapMode::CPU the whole chain laid out by MipmapGenerator::BuildChain(). May be an offset into a bound pixel unpack buffer.
+	 * @return Bytes of all levels, see GetMemorySize().
+	 */
+	static unsigned int Upload(const unsigned char* data, int width, int height, const TextureOptions& options);
+	/** Same as Upload() for a compressed image, data points at its Data(or the equivalent offset into a pixel unpack buffer). */
+	static unsigned int UploadCompressed(const unsigned char* data, const CompressedImage& image, const TextureOptions& options);
+	/** Sampling state of the texture bound to target. */
+	static void SetParameters(const TextureOptions& options, bool bMipmapped, unsigned int target = GL_TEXTURE_2D);
+
 private:
 	unsigned int m_RendererID;
+	/** The placeholder is owned by the loader and must not be deleted. */
+	bool m_bLoaded;
 
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	unsigned int m_MemorySize;
 };
@@ -0,0 +1,142 @@
+#include "TextureArray.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "AssetPack.h"
+#include "GLStateCache.h"
+#include "MipmapGenerator.h"
+
+#include "stb_image/stb_image.h"
+
+TextureArray::TextureArray(int width, int height, unsigned int capacity, const TextureOptions& options)
+	: m_RendererID(0)
+	, m_Width(width)
+	, m_Height(height)
+	, m_Capacity(std::min(capacity, GetMaxLayers()))
+	, m_LayerCount(0)
+	, m_Options(options)
+{
+	if (m_Capacity < capacity)
+	{
+		std::cout << "TextureArray: " << capacity << " layers requested, the driver supports " << m_Capacity << "!" << std::endl;
+	}
+
+	GLCALL(glGenTextures(1, &m_RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, m_RendererID);
+
+	const bool bMipmapped = options.Mipmaps != MipmapMode::None;
+	Texture::SetParameters(options, bMipmapped, GL_TEXTURE_2D_ARRAY);
+
+	const unsigned int levels = bMipmapped ? MipmapGenerator::GetLevelCount(width, height) : 1;
+	if (GLEW_ARB_texture_storage)
+	{
+		// Immutable storage, the driver knows the final layout and does not have to check completeness on every draw
+		GLCALL(glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, width, height, m_Capacity));
+	}
+	else
+	{
+		for (unsigned int level = 0; level < levels; ++level)
+		{
+			GLCALL(glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, std::max(1, width >> level), std::max(1, height >> level), m_Capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		}
+		GLCALL(glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	}
+
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, 0);
+}
+
+TextureArray::~TextureArray()
+{
+	GLCALL(glDeleteTextures(1, &m_RendererID));
+	GLStateCache::OnTextureDeleted(m_RendererID);
+}
+
+int TextureArray::Add(const std::string& filePath)
+{
+	int width, height, bpp;
+	// Same orientation as Texture
+	unsigned char* pixels = AssetPack::DecodeImage(filePath, width, height, bpp);
+	if (!pixels)
+	{
+		std::cout << "Failed to load texture array layer '" << filePath << "': " << stbi_failure_reason() << std::endl;
+		return -1;
+	}
+
+	int layer = -1;
+	if (width != m_Width || height != m_Height)
+	{
+		std::cout << "Texture array layer '" << filePath << "' is " << width << "x" << height << ", expected " << m_Width << "x" << m_Height << "!" << std::endl;
+	}
+	else
+	{
+		layer = Add(pixels);
+	}
+	stbi_image_free(pixels);
+	return layer;
+}
+
+int TextureArray::Add(const unsigned char* pixels)
+{
+	if (m_LayerCount >= m_Capacity)
+	{
+		std::cout << "TextureArray is full, " << m_Capacity << " layers!" << std::endl;
+		return -1;
+	}
+
+	const int layer = m_LayerCount++;
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, m_RendererID);
+	GLCALL(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+
+	if (m_Options.Mipmaps == MipmapMode::CPU)
+	{
+		const std::vector<unsigned char> chain = MipmapGenerator::BuildChain(pixels, m_Width, m_Height);
+		const unsigned char* data = chain.data();
+		int width = m_Width, height = m_Height;
+		const unsigned int levels = MipmapGenerator::GetLevelCount(m_Width, m_Height);
+		for (unsigned int level = 1; level < levels; ++level)
+		{
+			data += (size_t)width * height * 4;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			GLCALL(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data));
+		}
+	}
+
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, 0);
+	return layer;
+}
+
+void TextureArray::GenerateMipmaps()
+{
+	if (m_Options.Mipmaps != MipmapMode::GPU)
+	{
+		return;
+	}
+
+	// Regenerates every layer, so doing it per Add() would be quadratic
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, m_RendererID);
+	GLCALL(glGenerateMipmap(GL_TEXTURE_2D_ARRAY));
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, 0, 0);
+}
+
+unsigned int TextureArray::GetMaxLayers()
+{
+	static int s_MaxLayers = 0;
+	if (s_MaxLayers == 0)
+	{
+		GLCALL(glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &s_MaxLayers));
+	}
+	return (unsigned int)s_MaxLayers;
+}
+
+void TextureArray::Bind(unsigned int slot) const
+{
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, slot, m_RendererID);
+}
+
+void TextureArray::Unbind() const
+{
+	GLStateCache::BindTexture(GL_TEXTURE_2D_ARRAY, GLStateCache::GetActiveTextureSlot(), 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+#include "Texture.h"
+
+/**
+ * Many images of one size in a single GL_TEXTURE_2D_ARRAY, selected by a layer index in the shader.
+ * A batch can only bind as many textures as there are texture units, but it can reference every layer of an array through one of them,
+ * which makes arrays a good fit for uniformly sized assets like tiles and icons.
+ * Storage for all the layers is allocated up front, images are added one after another.
+ */
+class TextureArray
+{
+public:
+	TextureArray(int width, int height, unsigned int capacity, const TextureOptions& options = TextureOptions());
+	~TextureArray();
+
+	/** Decode an image file into the next free layer, returns the layer or -1 if the array is full, the file can not be decoded or its size differs. */
+	int Add(const std::string& filePath);
+	/** Copy tightly packed RGBA8 pixels of the array size into the next free layer, first row is the bottom one. Returns the layer or -1 if the array is full. */
+	int Add(const unsigned char* pixels);
+
+	/** With MipmapMode::GPU the smaller levels are only built here, call it once after the last Add(). Other modes need no call. */
+	void GenerateMipmaps();
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	/** Layers filled so far. */
+	inline unsigned int GetLayerCount() const { return m_LayerCount; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	/** Highest capacity the driver supports, at least 256 on GL 3.3. */
+	static unsigned int GetMaxLayers();
+
+	/** Bind to GL_TEXTURE_2D_ARRAY of the specified slot. */
+	void Bind(unsigned int slot = 0) const;
+	void Unbind() const;
+
+private:
+	unsigned int m_RendererID;
+	int m_Width, m_Height;
+	unsigned int m_Capacity;
+	unsigned int m_LayerCount;
+	TextureOptions m_Options;
+};
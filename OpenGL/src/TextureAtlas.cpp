@@ -0,0 +1,167 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "AssetPack.h"
+
+#include "stb_image/stb_image.h"
+
+// imgui_draw.cpp compiles its own private copy, so this one is private as well
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/imstb_rectpack.h"
+
+static int NextPowerOfTwo(int value)
+{
+	int result = 1;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+TextureAtlas::TextureAtlas(int pageSize, int padding, const TextureOptions& options)
+	: m_PageSize(pageSize)
+	, m_Padding(padding)
+	, m_Options(options)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+}
+
+TextureOptions TextureAtlas::GetDefaultOptions()
+{
+	TextureOptions options;
+	options.Mipmaps = MipmapMode::None;
+	return options;
+}
+
+int TextureAtlas::Add(const std::string& filePath)
+{
+	int width, height, bpp;
+	// Same orientation as Texture
+	unsigned char* pixels = AssetPack::DecodeImage(filePath, width, height, bpp);
+	if (!pixels)
+	{
+		std::cout << "Failed to load atlas image '" << filePath << "': " << stbi_failure_reason() << std::endl;
+		return -1;
+	}
+
+	const int region = Add(pixels, width, height);
+	stbi_image_free(pixels);
+	return region;
+}
+
+int TextureAtlas::Add(const unsigned char* pixels, int width, int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return -1;
+	}
+
+	const int region = (int)m_Regions.size();
+	QueuedImage image;
+	image.Region = region;
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.assign(pixels, pixels + width * height * 4);
+	m_QueuedImages.push_back(std::move(image));
+
+	m_Regions.push_back(AtlasRegion());
+	m_Regions.back().Width = width;
+	m_Regions.back().Height = height;
+	return region;
+}
+
+void TextureAtlas::Build()
+{
+	std::vector<stbrp_rect> rects(m_QueuedImages.size());
+	for (unsigned int i = 0; i < rects.size(); ++i)
+	{
+		rects[i].id = (int)i;
+		rects[i].w = (stbrp_coord)(m_QueuedImages[i].Width + 2 * m_Padding);
+		rects[i].h = (stbrp_coord)(m_QueuedImages[i].Height + 2 * m_Padding);
+	}
+
+	std::vector<stbrp_node> nodes(m_PageSize);
+	std::vector<unsigned char> pagePixels;
+	while (!rects.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, m_PageSize, m_PageSize, nodes.data(), (int)nodes.size());
+		stbrp_pack_rects(&context, rects.data(), (int)rects.size());
+
+		// The page only needs to cover what was placed on it
+		int pageWidth = 0, pageHeight = 0;
+		for (const stbrp_rect& rect : rects)
+		{
+			if (rect.was_packed)
+			{
+				pageWidth = std::max(pageWidth, rect.x + rect.w);
+				pageHeight = std::max(pageHeight, rect.y + rect.h);
+			}
+		}
+		if (pageWidth == 0)
+		{
+			// Nothing fits on an empty page, so the rest never will
+			std::cout << "TextureAtlas: " << rects.size() << " image(s) larger than a " << m_PageSize << "x" << m_PageSize << " page were skipped!" << std::endl;
+			break;
+		}
+		pageWidth = NextPowerOfTwo(pageWidth);
+		pageHeight = NextPowerOfTwo(pageHeight);
+
+		pagePixels.assign(pageWidth * pageHeight * 4, 0);
+		std::vector<stbrp_rect> remaining;
+		std::vector<int> placed;
+		for (const stbrp_rect& rect : rects)
+		{
+			if (!rect.was_packed)
+			{
+				remaining.push_back(rect);
+				continue;
+			}
+
+			const QueuedImage& image = m_QueuedImages[rect.id];
+			Blit(image, rect.x, rect.y, pagePixels.data(), pageWidth);
+
+			AtlasRegion& region = m_Regions[image.Region];
+			region.UVMin = glm::vec2((float)(rect.x + m_Padding) / pageWidth, (float)(rect.y + m_Padding) / pageHeight);
+			region.UVMax = region.UVMin + glm::vec2((float)image.Width / pageWidth, (float)image.Height / pageHeight);
+			placed.push_back(image.Region);
+		}
+
+		m_Pages.emplace_back(new Texture(pagePixels.data(), pageWidth, pageHeight, m_Options));
+		for (int index : placed)
+		{
+			m_Regions[index].Page = m_Pages.back().get();
+		}
+		rects.swap(remaining);
+	}
+
+	m_QueuedImages.clear();
+	m_QueuedImages.shrink_to_fit();
+}
+
+void TextureAtlas::Blit(const QueuedImage& image, int x, int y, unsigned char* page, int pageWidth) const
+{
+	const int paddedHeight = image.Height + 2 * m_Padding;
+	for (int row = 0; row < paddedHeight; ++row)
+	{
+		// Rows and columns of the border repeat the nearest edge of the image
+		const int srcRow = std::min(std::max(row - m_Padding, 0), image.Height - 1);
+		const unsigned char* src = &image.Pixels[srcRow * image.Width * 4];
+		unsigned char* dst = page + ((y + row) * pageWidth + x) * 4;
+
+		for (int column = 0; column < m_Padding; ++column)
+		{
+			memcpy(dst + column * 4, src, 4);
+			memcpy(dst + (m_Padding + image.Width + column) * 4, src + (image.Width - 1) * 4, 4);
+		}
+		memcpy(dst + m_Padding * 4, src, image.Width * 4);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Texture.h"
+
+/** Where an image ended up inside a TextureAtlas. */
+struct AtlasRegion
+{
+	/** nullptr if the image did not fit on a page. */
+	const Texture* Page = nullptr;
+	glm::vec2 UVMin = glm::vec2(0.f);
+	glm::vec2 UVMax = glm::vec2(0.f);
+	/** Size of the image in pixels, without padding. */
+	int Width = 0, Height = 0;
+};
+
+/**
+ * Packs many small images into a few large textures, so sprites which would each need a texture of their own can be drawn in one batch.
+ * Images are queued with Add() and placed by Build() with the skyline packer from stb_rect_pack, pages are filled one after another.
+ * Every image is surrounded by a border repeating its edge pixels, otherwise bilinear filtering would pull in the neighbouring image.
+ * The border only covers the first few mip levels, so pages are created without mipmaps by default.
+ */
+class TextureAtlas
+{
+public:
+	/**
+	 * @param pageSize - Largest width and height of a page, the last page is shrunk to the power of two its images fit into.
+	 * @param padding - Border in pixels around every image.
+	 */
+	TextureAtlas(int pageSize = 2048, int padding = 2, const TextureOptions& options = GetDefaultOptions());
+	~TextureAtlas();
+
+	/** Queue an image file, returns its region index or -1 if it can not be decoded. */
+	int Add(const std::string& filePath);
+	/** Queue tightly packed RGBA8 pixels(copied), first row is the bottom one, returns the region index. */
+	int Add(const unsigned char* pixels, int width, int height);
+
+	/** Pack every image queued since the last Build() onto new pages and upload them. Regions are valid from then on. */
+	void Build();
+
+	inline const AtlasRegion& GetRegion(int index) const { return m_Regions[index]; }
+	inline unsigned int GetRegionCount() const { return (unsigned int)m_Regions.size(); }
+	inline const Texture& GetPage(unsigned int index) const { return *m_Pages[index]; }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+
+	/** Mipmaps disabled, see class comment. */
+	static TextureOptions GetDefaultOptions();
+
+private:
+	struct QueuedImage
+	{
+		int Region;
+		int Width, Height;
+		std::vector<unsigned char> Pixels;
+	};
+
+	/** Copy an image and its border into the page pixels, x and y are the corner of the padded rectangle. */
+	void Blit(const QueuedImage& image, int x, int y, unsigned char* page, int pageWidth) const;
+
+private:
+	int m_PageSize;
+	int m_Padding;
+	TextureOptions m_Options;
+
+	/** Waiting for Build(), the pixels are released afterwards. */
+	std::vector<QueuedImage> m_QueuedImages;
+	std::vector<AtlasRegion> m_Regions;
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+
+};
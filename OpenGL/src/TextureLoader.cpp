@@ -0,0 +1,248 @@
+#include "TextureLoader.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "AssetPack.h"
+#include "GLStateCache.h"
+#include "MipmapGenerator.h"
+
+#include "stb_image/stb_image.h"
+
+// Small gray checker, shown while loading and kept by textures whose file could not be decoded
+static unsigned int CreateCheckerTexture()
+{
+	const unsigned char pixels[] = {
+		96, 96, 96, 255,    160, 160, 160, 255,
+		160, 160, 160, 255, 96, 96, 96, 255
+	};
+
+	unsigned int texture;
+	GLCALL(glGenTextures(1, &texture));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, texture);
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+	return texture;
+}
+
+TextureLoader::TextureLoader(unsigned int threadCount, unsigned int uploadBudget)
+	: m_UploadBudget(uploadBudget)
+	, m_Placeholder(CreateCheckerTexture())
+	, m_PendingCount(0)
+	, m_Workers(threadCount)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+	Flush();
+
+	GLCALL(glDeleteTextures(1, &m_Placeholder));
+	GLStateCache::OnTextureDeleted(m_Placeholder);
+}
+
+std::shared_ptr<Texture> TextureLoader::Load(const std::string& filePath, const TextureOptions& options)
+{
+	std::shared_ptr<Texture> texture(new Texture(filePath, m_Placeholder));
+	++m_PendingCount;
+
+	// Only a weak reference, a texture released before it is loaded is simply skipped
+	std::weak_ptr<Texture> target = texture;
+	m_Workers.Enqueue([this, target, filePath, options]()
+	{
+		DecodedImage image = { target, options, nullptr, std::vector<unsigned char>(), CompressedImage(), 0, 0 };
+		if (DDSFile::IsDDSFile(filePath))
+		{
+			if (DDSFile::Load(filePath, image.Compressed))
+			{
+				image.Width = image.Compressed.Width;
+				image.Height = image.Compressed.Height;
+			}
+			else
+			{
+				// A partially read file must not be staged
+				image.Compressed = CompressedImage();
+			}
+
+			std::lock_guard<std::mutex> lock(m_DecodedMutex);
+			m_DecodedImages.push_back(std::move(image));
+			return;
+		}
+
+		int bpp;
+		// Same orientation as Texture, decoded straight from the asset pack if it has the file
+		image.Pixels = AssetPack::DecodeImage(filePath, image.Width, image.Height, bpp);
+		if (!image.Pixels)
+		{
+			std::cout << "Failed to load texture '" << filePath << "': " << stbi_failure_reason() << std::endl;
+		}
+		else if (options.Mipmaps == MipmapMode::CPU)
+		{
+			image.MipChain = MipmapGenerator::BuildChain(image.Pixels, image.Width, image.Height);
+			stbi_image_free(image.Pixels);
+			image.Pixels = nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		m_DecodedImages.push_back(std::move(image));
+	});
+	return texture;
+}
+
+void TextureLoader::Update()
+{
+	FinishUploads(false);
+
+	std::vector<DecodedImage> images;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		unsigned int count = 0;
+		unsigned int stagedSize = 0;
+		while (count < m_DecodedImages.size() && (count == 0 || stagedSize < m_UploadBudget))
+		{
+			stagedSize += GetStagingSize(m_DecodedImages[count++]);
+		}
+		images.assign(std::make_move_iterator(m_DecodedImages.begin()), std::make_move_iterator(m_DecodedImages.begin() + count));
+		m_DecodedImages.erase(m_DecodedImages.begin(), m_DecodedImages.begin() + count);
+	}
+
+	// Staging is only a memcpy into driver memory, the workers keep decoding meanwhile
+	for (const DecodedImage& image : images)
+	{
+		StageUpload(image);
+	}
+}
+
+void TextureLoader::Flush()
+{
+	m_Workers.Wait();
+
+	std::vector<DecodedImage> images;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		images.swap(m_DecodedImages);
+	}
+	for (const DecodedImage& image : images)
+	{
+		StageUpload(image);
+	}
+
+	FinishUploads(true);
+}
+
+void TextureLoader::StageUpload(const DecodedImage& image)
+{
+	std::shared_ptr<Texture> texture = image.Target.lock();
+	const bool bCompressed = image.Compressed.Format != 0;
+	const unsigned char* pixels = bCompressed ? image.Compressed.Data.data() : image.MipChain.empty() ? image.Pixels : image.MipChain.data();
+	if (bCompressed && !Texture::IsCompressedFormatSupported(image.Compressed.Format))
+	{
+		std::cout << "Compressed format of a queued texture is not supported by the driver!" << std::endl;
+		pixels = nullptr;
+	}
+	if (!texture || !pixels)
+	{
+		if (texture)
+		{
+			// Give it a checker of its own, the shared placeholder goes away with the loader
+			texture->OnLoaded(CreateCheckerTexture(), 2, 2, 2 * 2 * 4);
+		}
+		stbi_image_free(image.Pixels);
+		--m_PendingCount;
+		return;
+	}
+
+	const unsigned int size = GetStagingSize(image);
+
+	PendingUpload upload = { image.Target, 0, 0, image.Width, image.Height, 0, nullptr };
+	GLCALL(glGenBuffers(1, &upload.PixelBuffer));
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, upload.PixelBuffer);
+	GLCALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	GLCALL(void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	const unsigned char* source = nullptr;
+	if (mapped)
+	{
+		memcpy(mapped, pixels, size);
+		GLCALL(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	}
+	else
+	{
+		// Mapping failed, upload from client memory instead, which waits for the copy
+		GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		GLCALL(glDeleteBuffers(1, &upload.PixelBuffer));
+		GLStateCache::OnBufferDeleted(upload.PixelBuffer);
+		upload.PixelBuffer = 0;
+		source = pixels;
+	}
+
+	GLCALL(glGenTextures(1, &upload.RendererID));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, upload.RendererID);
+	// With a pixel unpack buffer bound the data pointer is an offset into it, so this returns without waiting for the copy
+	if (bCompressed)
+	{
+		upload.MemorySize = Texture::UploadCompressed(source, image.Compressed, image.Options);
+	}
+	else
+	{
+		upload.MemorySize = Texture::Upload(source, image.Width, image.Height, image.Options);
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+	// Every other upload reads from client memory
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	stbi_image_free(image.Pixels);
+
+	if (upload.PixelBuffer == 0)
+	{
+		// Already copied, nothing to wait for
+		texture->OnLoaded(upload.RendererID, upload.Width, upload.Height, upload.MemorySize);
+		--m_PendingCount;
+		return;
+	}
+
+	GLCALL(upload.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+	m_PendingUploads.push_back(upload);
+}
+
+unsigned int TextureLoader::GetStagingSize(const DecodedImage& image)
+{
+	if (image.Compressed.Format != 0)
+	{
+		return (unsigned int)image.Compressed.Data.size();
+	}
+	return image.MipChain.empty() ? image.Width * image.Height * 4 : (unsigned int)image.MipChain.size();
+}
+
+void TextureLoader::FinishUploads(bool bWait)
+{
+	while (!m_PendingUploads.empty())
+	{
+		PendingUpload& upload = m_PendingUploads.front();
+		// Without waiting there is no need to flush, the next buffer swap does that
+		GLCALL(GLenum result = glClientWaitSync(upload.Fence, bWait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, bWait ? GL_TIMEOUT_IGNORED : 0));
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			return;
+		}
+
+		GLCALL(glDeleteSync(upload.Fence));
+		GLCALL(glDeleteBuffers(1, &upload.PixelBuffer));
+		GLStateCache::OnBufferDeleted(upload.PixelBuffer);
+
+		if (std::shared_ptr<Texture> texture = upload.Target.lock())
+		{
+			texture->OnLoaded(upload.RendererID, upload.Width, upload.Height, upload.MemorySize);
+		}
+		else
+		{
+			GLCALL(glDeleteTextures(1, &upload.RendererID));
+			GLStateCache::OnTextureDeleted(upload.RendererID);
+		}
+
+		--m_PendingCount;
+		m_PendingUploads.pop_front();
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "ThreadPool.h"
+#include "Texture.h"
+
+/**
+ * Streams textures in without blocking the frame.
+ * Files are decoded(or for ".dds" just read) on worker threads, the pixels are staged into pixel buffer objects by Update() and the transfer is left to finish in the background,
+ * a texture only switches from the placeholder to its image once the GPU is done with it, usually a frame or two later.
+ * Everything except decoding happens on the thread owning the GL context.
+ */
+class TextureLoader
+{
+public:
+	/**
+	 * @param uploadBudget - Bytes staged per Update() at most, spreads a burst of loads over several frames. At least one image is staged each time.
+	 */
+	TextureLoader(unsigned int threadCount = 0, unsigned int uploadBudget = 8 * 1024 * 1024);
+	/** Finish all the outstanding loads, so no texture is left showing the placeholder. */
+	~TextureLoader();
+
+	/** Queue a file for loading, the returned texture can be bound right away. With MipmapMode::CPU the chain is built on the worker too. */
+	std::shared_ptr<Texture> Load(const std::string& filePath, const TextureOptions& options = TextureOptions());
+
+	/** Call once per frame: hand over finished transfers and stage newly decoded images. */
+	void Update();
+	/** Block until every queued load has been handed over. */
+	void Flush();
+
+	/** Loads which have not been handed over yet. */
+	inline unsigned int GetPendingCount() const { return m_PendingCount; }
+
+private:
+	struct DecodedImage
+	{
+		std::weak_ptr<Texture> Target;
+		TextureOptions Options;
+		/** Owned by stb_image, nullptr if decoding failed or the pixels were moved into MipChain. */
+		unsigned char* Pixels;
+		/** Every level, only with MipmapMode::CPU. */
+		std::vector<unsigned char> MipChain;
+		/** Read from a ".dds" file instead of decoding, Format is 0 otherwise. */
+		CompressedImage Compressed;
+		int Width, Height;
+	};
+
+	struct PendingUpload
+	{
+		std::weak_ptr<Texture> Target;
+		unsigned int RendererID;
+		unsigned int PixelBuffer;
+		int Width, Height;
+		unsigned int MemorySize;
+		GLsync Fence;
+	};
+
+	static unsigned int GetStagingSize(const DecodedImage& image);
+	/** Copy one image into a new pixel buffer and start the transfer into a new texture object. */
+	void StageUpload(const DecodedImage& image);
+	/** Hand over transfers which are complete, or all of them with bWait. */
+	void FinishUploads(bool bWait);
+
+private:
+	unsigned int m_UploadBudget;
+	/** 2x2 checker shown by textures which are still loading. */
+	unsigned int m_Placeholder;
+	unsigned int m_PendingCount;
+
+	/** Filled by the workers. */
+	std::vector<DecodedImage> m_DecodedImages;
+	std::mutex m_DecodedMutex;
+
+	/** In submission order, so fences signal front to back. */
+	std::deque<PendingUpload> m_PendingUploads;
+
+	/** Declared last, so the workers are joined before the members they write to are destroyed. */
+	ThreadPool m_Workers;
+
+};
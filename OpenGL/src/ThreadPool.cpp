@@ -0,0 +1,78 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+	: m_PendingJobs(0)
+	, m_bStopping(false)
+{
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bStopping = true;
+	}
+	m_JobAvailable.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Jobs.push(std::move(job));
+		++m_PendingJobs;
+	}
+	m_JobAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_AllJobsDone.wait(lock, [this]() { return m_PendingJobs == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobAvailable.wait(lock, [this]() { return m_bStopping || !m_Jobs.empty(); });
+			// Drain the queue before stopping
+			if (m_Jobs.empty())
+			{
+				return;
+			}
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+
+		job();
+
+		bool bAllDone;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			bAllDone = --m_PendingJobs == 0;
+		}
+		if (bAllDone)
+		{
+			m_AllJobsDone.notify_all();
+		}
+	}
+}
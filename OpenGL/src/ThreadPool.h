@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/** Fixed set of worker threads executing queued jobs in FIFO order. Jobs MUST NOT call GL. */
+class ThreadPool
+{
+public:
+	/** 0 means one thread less than the hardware concurrency(at least 1), leaving a core for the GL thread. */
+	ThreadPool(unsigned int threadCount = 0);
+	/** Finish all the queued jobs and join the workers. */
+	~ThreadPool();
+
+	void Enqueue(std::function<void()> job);
+	/** Block the calling thread until the queue is empty and no job is running. */
+	void Wait();
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size(); }
+
+private:
+	void WorkerLoop();
+
+private:
+	std::vector<std::thread> m_Workers;
+	std::queue<std::function<void()>> m_Jobs;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_JobAvailable;
+	std::condition_variable m_AllJobsDone;
+	/** Queued plus running jobs. */
+	unsigned int m_PendingJobs;
+	bool m_bStopping;
+
+};
@@ -0,0 +1,50 @@
+#include "UniformBuffer.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, BufferUsage usage)
+	: m_Size(size)
+	, m_Usage(usage)
+{
+	GLCALL(glCreateBuffers(1, &m_RendererID));
+	// Uniform buffer bindings are not cached, the generic target is only used for allocating
+	GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCALL(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GetGLBufferUsage(usage)));
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLCALL(glDeleteBuffers(1, &m_RendererID));
+	GLStateCache::OnBufferDeleted(m_RendererID);
+}
+
+void UniformBuffer::SetData(unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+
+	GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+	GLCALL(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+void UniformBuffer::Bind(unsigned int binding) const
+{
+	GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID));
+}
+
+void UniformBuffer::BindRange(unsigned int binding, unsigned int offset, unsigned int size) const
+{
+	ASSERT(offset % GetOffsetAlignment() == 0);
+
+	GLCALL(glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, offset, size));
+}
+
+unsigned int UniformBuffer::GetOffsetAlignment()
+{
+	static int s_Alignment = 0;
+	if (s_Alignment == 0)
+	{
+		GLCALL(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &s_Alignment));
+	}
+	return (unsigned int)s_Alignment;
+}
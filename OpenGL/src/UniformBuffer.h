@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BufferUsage.h"
+#include "Std140.h"
+
+/**
+ * Binding points of the uniform blocks shared by all shaders.
+ * Shader binds every block declared with one of UniformBlockNames to the matching binding point right after linking.
+ */
+enum UniformBlockBinding : unsigned int
+{
+	/** Data constant over a frame, e.g. camera matrices. */
+	FrameBlockBinding = 0,
+	/** Data of the object being drawn, usually a range of a UniformRing. */
+	ObjectBlockBinding,
+	UniformBlockBindingCount
+};
+
+static const char* const UniformBlockNames[UniformBlockBindingCount] = { "FrameData", "ObjectData" };
+
+/** layout(std140) uniform FrameData { mat4 u_ViewProj; }; */
+typedef Std140Layout<glm::mat4> FrameBlockLayout;
+/** layout(std140) uniform ObjectData { mat4 u_Model; }; */
+typedef Std140Layout<glm::mat4> ObjectBlockLayout;
+
+/** Uniform values living in a buffer object, bound once and shared by every program declaring the block. */
+class UniformBuffer
+{
+public:
+	/** Size means bytes. */
+	UniformBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
+	~UniformBuffer();
+
+	void SetData(unsigned int offset, const void* data, unsigned int size);
+
+	/** Bind the whole buffer to an indexed uniform buffer binding point. */
+	void Bind(unsigned int binding) const;
+	/** Bind a range, offset must be a multiple of GetOffsetAlignment(). */
+	void BindRange(unsigned int binding, unsigned int offset, unsigned int size) const;
+
+	inline unsigned int GetSize() const { return m_Size; }
+
+	/** GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, queried once. */
+	static unsigned int GetOffsetAlignment();
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	BufferUsage m_Usage;
+
+};
@@ -0,0 +1,48 @@
+#include "UniformRing.h"
+
+#include <cstring>
+
+#include "Renderer.h"
+#include "StreamBuffer.h"
+#include "UniformBuffer.h"
+
+UniformRing::UniformRing(unsigned int regionSize)
+	: m_OffsetAlignment(UniformBuffer::GetOffsetAlignment())
+	, m_WrapCount(0)
+{
+	// Regions start at multiples of their size, keep those aligned too
+	regionSize = (regionSize + m_OffsetAlignment - 1) / m_OffsetAlignment * m_OffsetAlignment;
+	m_Buffer.reset(new StreamBuffer(GL_UNIFORM_BUFFER, regionSize));
+}
+
+UniformRing::~UniformRing()
+{
+}
+
+void UniformRing::BeginFrame()
+{
+	m_Buffer->BeginFrame();
+}
+
+void UniformRing::EndFrame()
+{
+	m_Buffer->EndFrame();
+}
+
+void UniformRing::Push(unsigned int binding, const void* data, unsigned int size)
+{
+	StreamBuffer::Allocation allocation = m_Buffer->Allocate(size, m_OffsetAlignment);
+	if (!allocation.Data)
+	{
+		// Draws reading the previous ranges have been issued already, so the region can be fenced now
+		m_Buffer->EndFrame();
+		m_Buffer->BeginFrame();
+		allocation = m_Buffer->Allocate(size, m_OffsetAlignment);
+		ASSERT(allocation.Data);
+		++m_WrapCount;
+	}
+
+	memcpy(allocation.Data, data, size);
+	m_Buffer->Flush(allocation);
+	GLCALL(glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_Buffer->GetRendererID(), allocation.Offset, size));
+}
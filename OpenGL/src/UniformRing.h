@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+
+class StreamBuffer;
+
+/**
+ * Per-draw uniform data streamed through one large uniform buffer.
+ * Every Push() takes a fresh aligned range of the current frame's region and binds it, so consecutive draws never wait on each other.
+ */
+class UniformRing
+{
+public:
+	/** regionSize is the number of bytes which can be pushed per frame before the ring has to wait on the GPU. */
+	UniformRing(unsigned int regionSize = 256 * 1024);
+	~UniformRing();
+
+	void BeginFrame();
+	void EndFrame();
+
+	/** Copy size bytes into the ring and bind that range to the uniform block binding point, the data only has to outlive the call. */
+	void Push(unsigned int binding, const void* data, unsigned int size);
+
+	/** Pushes which found the region full and had to start a new one. */
+	inline unsigned int GetWrapCount() const { return m_WrapCount; }
+
+private:
+	std::unique_ptr<StreamBuffer> m_Buffer;
+	unsigned int m_OffsetAlignment;
+	unsigned int m_WrapCount;
+
+};
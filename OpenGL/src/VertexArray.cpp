@@ -1,10 +1,15 @@
 #include "VertexArray.h"
 
+#include <iostream>
+
 #include "Renderer.h"
+#include "Shader.h"
+#include "GLStateCache.h"
 #include "VertexBuffer.h"
-#include "VertexBufferLayout.h"
+#include "StreamBuffer.h"
 
 VertexArray::VertexArray()
+	: m_VertexAttribIndex(0)
 {
 	// Generate vertex array object names
 	GLCALL(glCreateVertexArrays(1, &m_RendererID));
@@ -14,32 +19,118 @@ VertexArray::~VertexArray()
 {
 	// Delete vertex array objects
 	GLCALL(glDeleteVertexArrays(1, &m_RendererID));
+	GLStateCache::OnVertexArrayDeleted(m_RendererID);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
 	// Bind
-	GLCALL(glBindVertexArray(m_RendererID));
+	GLStateCache::BindVertexArray(m_RendererID);
 	vb.Bind();
+	SetupAttributes(layout);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+	// Bind
+	GLStateCache::BindVertexArray(m_RendererID);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, sb.GetRendererID());
+	SetupAttributes(layout);
+}
+
+void VertexArray::SetupAttributes(const VertexBufferLayout& layout)
+{
+	// Attributes source from the buffer currently bound to GL_ARRAY_BUFFER
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size(); ++i)
 	{
 		const auto& element = elements[i];
+		const unsigned int index = m_VertexAttribIndex + i;
 		// Enable the specified vertex attribute data
-		GLCALL(glEnableVertexAttribArray(i));
+		GLCALL(glEnableVertexAttribArray(index));
 		// Define the specified vertex attribute data
-		GLCALL(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		GLCALL(glVertexAttribPointer(index, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
+		if (element.divisor != 0)
+		{
+			// Advance this attribute per instance rather than per vertex
+			GLCALL(glVertexAttribDivisor(index, element.divisor));
+		}
+		m_Attributes.push_back(element);
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
+	m_VertexAttribIndex += (unsigned int)elements.size();
+	// The layout changed, check it again on the next draw
+	m_ValidatedPrograms.clear();
+}
+
+// Number of locations an attribute of the given type occupies and whether the shader reads it as integers
+static unsigned int GetAttributeLocationCount(unsigned int type, bool& bInteger)
+{
+	bInteger = false;
+	switch (type)
+	{
+	case GL_INT:
+	case GL_INT_VEC2:
+	case GL_INT_VEC3:
+	case GL_INT_VEC4:
+	case GL_UNSIGNED_INT:
+	case GL_UNSIGNED_INT_VEC2:
+	case GL_UNSIGNED_INT_VEC3:
+	case GL_UNSIGNED_INT_VEC4:
+		bInteger = true;
+		return 1;
+	case GL_FLOAT_MAT2:
+		return 2;
+	case GL_FLOAT_MAT3:
+		return 3;
+	case GL_FLOAT_MAT4:
+		return 4;
+	default:
+		return 1;
+	}
+}
+
+bool VertexArray::Validate(const Shader& shader) const
+{
+	auto validated = m_ValidatedPrograms.find(shader.GetUniqueID());
+	if (validated != m_ValidatedPrograms.end())
+	{
+		return validated->second;
+	}
+
+	bool bValid = true;
+	for (const ShaderAttribute& attribute : shader.GetAttributes())
+	{
+		bool bInteger;
+		const unsigned int locationCount = GetAttributeLocationCount(attribute.Type, bInteger) * attribute.Size;
+		for (unsigned int i = 0; i < locationCount; ++i)
+		{
+			const unsigned int location = attribute.Location + i;
+			if (location >= m_Attributes.size())
+			{
+				// A disabled attribute silently reads the current generic value instead
+				std::cout << "Warning: attribute '" << attribute.Name << "' (location " << location << ") is not sourced from any vertex buffer!" << std::endl;
+				bValid = false;
+			}
+			else if (bInteger)
+			{
+				// Layouts are set up with glVertexAttribPointer, which converts to float
+				std::cout << "Warning: attribute '" << attribute.Name << "' is read as integer but supplied as float!" << std::endl;
+				bValid = false;
+			}
+		}
+	}
+	m_ValidatedPrograms[shader.GetUniqueID()] = bValid;
+	return bValid;
 }
 
 void VertexArray::Bind() const
 {
-	GLCALL(glBindVertexArray(m_RendererID));
+	GLStateCache::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCALL(glBindVertexArray(0));
+	GLStateCache::BindVertexArray(0);
 }
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+class Shader;
 class VertexBuffer;
-class VertexBufferLayout;
+class StreamBuffer;
 
 class VertexArray
 {
@@ -9,13 +15,34 @@ public:
 	VertexArray();
 	~VertexArray();
 
+	/**
+	 * Attach a vertex buffer with its layout.
+	 * Can be called multiple times (e.g. a per-vertex stream followed by a per-instance stream), attribute locations continue from the previous buffer.
+	 */
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	/** Source vertices from a stream buffer, draws should then pass the allocation's offset as base vertex. */
+	void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
+
+	/**
+	 * Check the attached layouts against the inputs of a program: every attribute it reads has to be sourced from a buffer, with matching float/integer type.
+	 * Mismatches are printed, the result is remembered so repeated calls with the same program cost nothing.
+	 */
+	bool Validate(const Shader& shader) const;
 
 	/** Bind a vertex array object. */
 	void Bind() const;
 	/** Unbind vertex array objects. */
 	void Unbind() const;
 
+private:
+	void SetupAttributes(const VertexBufferLayout& layout);
+
 private:
 	unsigned int m_RendererID;
+	/** Next vertex attribute location to be used by AddBuffer(). */
+	unsigned int m_VertexAttribIndex;
+	/** Format of every enabled attribute, indexed by location. */
+	std::vector<VertexBufferElement> m_Attributes;
+	/** Result for every shader passed to Validate() since the layout last changed, by Shader::GetUniqueID() since program names get reused. */
+	mutable std::unordered_map<unsigned int, bool> m_ValidatedPrograms;
 };
@@ -1,31 +1,120 @@
 #include "VertexBuffer.h"
 
+#include <cstring>
+
 #include "Renderer.h"
+#include "GLStateCache.h"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, BufferUsage usage)
+	: m_Size(size)
+	, m_Usage(usage)
+	, m_UntouchedOffset(data ? size : 0)
 {
 	// Generate vertex buffer object names
 	GLCALL(glCreateBuffers(1, &m_RendererID));
 	// Bind
-	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 	// Create and initialize a vertex buffer object's data store
-	GLCALL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GLCALL(glBufferData(GL_ARRAY_BUFFER, size, data, GetGLBufferUsage(usage)));
 	// Unbind
-	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+	: VertexBuffer(nullptr, size, usage)
+{
 }
 
 VertexBuffer::~VertexBuffer()
 {
 	// Delete named buffer objects
 	GLCALL(glDeleteBuffers(1, &m_RendererID));
+	GLStateCache::OnBufferDeleted(m_RendererID);
+}
+
+void VertexBuffer::SetData(unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	void* mapped = nullptr;
+	if (m_Usage != BufferUsage::Static && offset >= m_UntouchedOffset)
+	{
+		// Nothing the GPU may still read lives in this range, so skip the implicit synchronization
+		GLCALL(mapped = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	}
+	if (mapped)
+	{
+		memcpy(mapped, data, size);
+		GLCALL(glUnmapBuffer(GL_ARRAY_BUFFER));
+	}
+	else
+	{
+		// Update a subset of the data store instead of reallocating it, the driver takes care of pending reads. Also the fallback if mapping failed
+		GLCALL(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+	}
+	if (offset + size > m_UntouchedOffset)
+	{
+		m_UntouchedOffset = offset + size;
+	}
+}
+
+void VertexBuffer::Resize(unsigned int size, bool bKeepData)
+{
+	unsigned int copySize = bKeepData ? (size < m_UntouchedOffset ? size : m_UntouchedOffset) : 0;
+	unsigned int tempBuffer = 0;
+	if (copySize > 0)
+	{
+		// Park the old contents in a temporary buffer as reallocating discards them
+		GLCALL(glGenBuffers(1, &tempBuffer));
+		GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, tempBuffer));
+		GLCALL(glBufferData(GL_COPY_WRITE_BUFFER, copySize, nullptr, GL_STREAM_COPY));
+		GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_RendererID));
+		GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copySize));
+	}
+
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	GLCALL(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GetGLBufferUsage(m_Usage)));
+	m_Size = size;
+	m_UntouchedOffset = copySize;
+
+	if (copySize > 0)
+	{
+		GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, tempBuffer));
+		GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+		GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copySize));
+		GLCALL(glDeleteBuffers(1, &tempBuffer));
+		GLStateCache::OnBufferDeleted(tempBuffer);
+	}
+}
+
+void VertexBuffer::CopySubData(unsigned int readOffset, unsigned int writeOffset, unsigned int size)
+{
+	ASSERT(readOffset + size <= writeOffset || writeOffset + size <= readOffset);
+
+	GLCALL(glBindBuffer(GL_COPY_READ_BUFFER, m_RendererID));
+	GLCALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+	GLCALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, readOffset, writeOffset, size));
+	if (writeOffset + size > m_UntouchedOffset)
+	{
+		m_UntouchedOffset = writeOffset + size;
+	}
+}
+
+void VertexBuffer::Orphan()
+{
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+	// Same size and null data lets the driver hand out a new store while the old one is still read by the GPU
+	GLCALL(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GetGLBufferUsage(m_Usage)));
+	m_UntouchedOffset = 0;
 }
 
 void VertexBuffer::Bind() const
 {
-	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-	GLCALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -1,12 +1,28 @@
 #pragma once
 
+#include "BufferUsage.h"
+
 class VertexBuffer
 {
 public:
 	/** Size means bytes. */
-	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(const void* data, unsigned int size, BufferUsage usage = BufferUsage::Static);
+	/** Create an empty vertex buffer with the specified size(in bytes) to be filled via SetData(). */
+	VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
 	~VertexBuffer();
 
+	/** Update size bytes of this vertex buffer's data store starting at offset(in bytes). */
+	void SetData(unsigned int offset, const void* data, unsigned int size);
+	/** Reallocate the data store with the new size(in bytes), the name stays the same so vertex arrays referring to it remain valid. */
+	void Resize(unsigned int size, bool bKeepData = true);
+	/** Copy size bytes within this buffer on the GPU, offsets are in bytes and the two ranges must not overlap. */
+	void CopySubData(unsigned int readOffset, unsigned int writeOffset, unsigned int size);
+	/** Detach the data store from the GPU's pending reads and get a fresh one of the same size, the contents become undefined. */
+	void Orphan();
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+
 	/** Bind a named vertex buffer object. */
 	void Bind() const;
 	/** Unbind vertex buffer objects. */
@@ -14,4 +30,8 @@ public:
 
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;
+	BufferUsage m_Usage;
+	/** Bytes from here to the end have not been written since the data store was allocated, so the GPU cannot be reading them. */
+	unsigned int m_UntouchedOffset;
 };
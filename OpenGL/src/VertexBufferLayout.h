@@ -9,6 +9,8 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	/** 0 means advancing per vertex, N means advancing once every N instances. */
+	unsigned int divisor;
 
 	static unsigned int GetSizeOfType(unsigned int type)
 	{
@@ -40,30 +42,31 @@ public:
 
 	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 
+	/** Divisor other than 0 makes this attribute a per-instance attribute. */
 	template<typename T>
-	void Push(unsigned int count)
+	void Push(unsigned int count, unsigned int divisor = 0)
 	{
 		static_assert(false);
 	}
 
 	template<>
-	void Push<float>(unsigned int count)
+	void Push<float>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
+		m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
 	}
 
 	template<>
-	void Push<unsigned int>(unsigned int count)
+	void Push<unsigned int>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
 	}
 
 	template<>
-	void Push<unsigned char>(unsigned int count)
+	void Push<unsigned char>(unsigned int count, unsigned int divisor)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
 		m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
 	}
 
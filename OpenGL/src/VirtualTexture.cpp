@@ -0,0 +1,471 @@
+#include "VirtualTexture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "GLStateCache.h"
+#include "Shader.h"
+
+// Requests beyond this wait for a later feedback, so a fast moving camera does not queue pages which are gone by the time they are read
+static const unsigned int MaxPendingPages = 64;
+// Read backs which have not signalled yet are skipped rather than stalling, feedback a few frames old is good enough
+static const unsigned int MaxReadbacks = 3;
+
+VirtualTexture::VirtualTexture(const std::string& pageFilePath, unsigned int cacheSize, unsigned int uploadBudget, unsigned int threadCount)
+	: m_CacheSize(std::min(cacheSize, 255u))
+	, m_UploadBudget(uploadBudget)
+	, m_Frame(0)
+	, m_LodBias(0.f)
+	, m_PageCache(0)
+	, m_Indirection(0)
+	, m_bIndirectionDirty(true)
+	, m_FeedbackFramebuffer(0)
+	, m_FeedbackColor(0)
+	, m_FeedbackDepth(0)
+	, m_FeedbackWidth(0)
+	, m_FeedbackHeight(0)
+	, m_SavedViewport{}
+	, m_SavedClearColor{}
+	, m_bSavedBlend(false)
+	, m_Workers(threadCount)
+{
+	if (!m_File.Open(pageFilePath))
+	{
+		return;
+	}
+
+	const unsigned int cacheTextureSize = GetCacheTextureSize();
+	GLCALL(glGenTextures(1, &m_PageCache));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_PageCache);
+	// Pages carry their own border, so bilinear filtering never reaches into the neighbouring slot. Levels are separate pages, the cache has no mipmaps
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+	GLCALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheTextureSize, cacheTextureSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+	// One texel per page, level l of the texture holds the pages of level l of the image
+	const unsigned int levelCount = m_File.GetLevelCount();
+	const unsigned int tableSize = m_File.GetPageTableSize();
+	GLCALL(glGenTextures(1, &m_Indirection));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_Indirection);
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+	GLCALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1));
+	m_IndirectionLevels.resize(levelCount);
+	for (unsigned int level = 0; level < levelCount; ++level)
+	{
+		const unsigned int size = tableSize >> level;
+		m_IndirectionLevels[level].assign(size * size * 4, 0);
+		GLCALL(glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+
+	m_Slots.resize(m_CacheSize * m_CacheSize);
+	for (unsigned int i = (unsigned int)m_Slots.size(); i > 0; --i)
+	{
+		m_FreeSlots.push_back(i - 1);
+	}
+
+	// The last level is the fallback of every other page, it is read right away and never evicted
+	LoadedPage root = { MakeKey(levelCount - 1, 0, 0), std::vector<unsigned char>(m_File.GetPageByteSize()) };
+	if (!m_File.ReadPage(levelCount - 1, 0, 0, root.Pixels.data()))
+	{
+		std::cout << "Failed to read the last level of '" << pageFilePath << "'!" << std::endl;
+	}
+	UploadPage(root);
+	UpdateIndirection();
+}
+
+VirtualTexture::~VirtualTexture()
+{
+	for (const FeedbackReadback& readback : m_Readbacks)
+	{
+		GLCALL(glDeleteSync(readback.Fence));
+		m_FreeReadbackBuffers.push_back(readback.PixelBuffer);
+	}
+	for (unsigned int buffer : m_FreeReadbackBuffers)
+	{
+		GLCALL(glDeleteBuffers(1, &buffer));
+		GLStateCache::OnBufferDeleted(buffer);
+	}
+
+	GLCALL(glDeleteFramebuffers(1, &m_FeedbackFramebuffer));
+	GLCALL(glDeleteRenderbuffers(1, &m_FeedbackColor));
+	GLCALL(glDeleteRenderbuffers(1, &m_FeedbackDepth));
+
+	GLCALL(glDeleteTextures(1, &m_PageCache));
+	GLStateCache::OnTextureDeleted(m_PageCache);
+	GLCALL(glDeleteTextures(1, &m_Indirection));
+	GLStateCache::OnTextureDeleted(m_Indirection);
+}
+
+void VirtualTexture::BeginFeedback(Shader& feedbackShader)
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	GLCALL(glGetIntegerv(GL_VIEWPORT, m_SavedViewport));
+	GLCALL(glGetFloatv(GL_COLOR_CLEAR_VALUE, m_SavedClearColor));
+	GLCALL(m_bSavedBlend = glIsEnabled(GL_BLEND) == GL_TRUE);
+	ResizeFeedback(m_SavedViewport[2], m_SavedViewport[3]);
+
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, m_FeedbackFramebuffer));
+	GLCALL(glViewport(0, 0, m_FeedbackWidth, m_FeedbackHeight));
+	// Page ids must not be blended, alpha 0 marks pixels without a sample
+	GLCALL(glDisable(GL_BLEND));
+	GLCALL(glClearColor(0.f, 0.f, 0.f, 0.f));
+	GLCALL(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+	// Derivatives are FeedbackDivisor times larger in the small buffer
+	SetUniforms(feedbackShader, m_LodBias - std::log2((float)FeedbackDivisor));
+}
+
+void VirtualTexture::EndFeedback()
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	if (m_Readbacks.size() < MaxReadbacks)
+	{
+		FeedbackReadback readback = { 0, (unsigned int)(m_FeedbackWidth * m_FeedbackHeight), nullptr };
+		if (!m_FreeReadbackBuffers.empty())
+		{
+			readback.PixelBuffer = m_FreeReadbackBuffers.back();
+			m_FreeReadbackBuffers.pop_back();
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.PixelBuffer);
+		}
+		else
+		{
+			GLCALL(glGenBuffers(1, &readback.PixelBuffer));
+			GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.PixelBuffer);
+			GLCALL(glBufferData(GL_PIXEL_PACK_BUFFER, readback.PixelCount * 4, nullptr, GL_STREAM_READ));
+		}
+
+		// With a pixel pack buffer bound this only queues the copy, the pixels are mapped once the fence has signalled
+		GLCALL(glReadPixels(0, 0, m_FeedbackWidth, m_FeedbackHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		GLCALL(readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		m_Readbacks.push_back(readback);
+	}
+
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCALL(glViewport(m_SavedViewport[0], m_SavedViewport[1], m_SavedViewport[2], m_SavedViewport[3]));
+	GLCALL(glClearColor(m_SavedClearColor[0], m_SavedClearColor[1], m_SavedClearColor[2], m_SavedClearColor[3]));
+	if (m_bSavedBlend)
+	{
+		GLCALL(glEnable(GL_BLEND));
+	}
+}
+
+void VirtualTexture::Update()
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	++m_Frame;
+
+	while (!m_Readbacks.empty())
+	{
+		FeedbackReadback& readback = m_Readbacks.front();
+		// The next buffer swap flushes, there is no need to do it here
+		GLCALL(GLenum result = glClientWaitSync(readback.Fence, 0, 0));
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			break;
+		}
+		GLCALL(glDeleteSync(readback.Fence));
+
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.PixelBuffer);
+		GLCALL(const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.PixelCount * 4, GL_MAP_READ_BIT));
+		if (pixels)
+		{
+			ProcessFeedback((const unsigned char*)pixels, readback.PixelCount);
+		}
+		GLCALL(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (readback.PixelCount == (unsigned int)(m_FeedbackWidth * m_FeedbackHeight))
+		{
+			m_FreeReadbackBuffers.push_back(readback.PixelBuffer);
+		}
+		else
+		{
+			// Read before the viewport was resized
+			GLCALL(glDeleteBuffers(1, &readback.PixelBuffer));
+			GLStateCache::OnBufferDeleted(readback.PixelBuffer);
+		}
+		m_Readbacks.pop_front();
+	}
+
+	std::vector<LoadedPage> pages;
+	{
+		std::lock_guard<std::mutex> lock(m_LoadedMutex);
+		const size_t count = std::min((size_t)m_UploadBudget, m_LoadedPages.size());
+		pages.assign(std::make_move_iterator(m_LoadedPages.begin()), std::make_move_iterator(m_LoadedPages.begin() + count));
+		m_LoadedPages.erase(m_LoadedPages.begin(), m_LoadedPages.begin() + count);
+	}
+	for (size_t i = 0; i < pages.size(); ++i)
+	{
+		if (!pages[i].Pixels.empty() && !UploadPage(pages[i]))
+		{
+			// Every slot is on screen, the rest stays loaded and pending until one frees up instead of being read again
+			std::lock_guard<std::mutex> lock(m_LoadedMutex);
+			m_LoadedPages.insert(m_LoadedPages.begin(), std::make_move_iterator(pages.begin() + i), std::make_move_iterator(pages.end()));
+			break;
+		}
+		if (pages[i].Pixels.empty())
+		{
+			m_FailedPages.insert(pages[i].Page);
+		}
+		m_PendingPages.erase(pages[i].Page);
+	}
+
+	if (m_bIndirectionDirty)
+	{
+		UpdateIndirection();
+	}
+
+	m_Stats.ResidentPages = (unsigned int)m_ResidentPages.size();
+	m_Stats.PendingPages = (unsigned int)m_PendingPages.size();
+}
+
+void VirtualTexture::Bind(Shader& shader, unsigned int slot) const
+{
+	GLStateCache::BindTexture(GL_TEXTURE_2D, slot, m_PageCache);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, slot + 1, m_Indirection);
+	shader.SetUniform1i("u_PageCache", slot);
+	shader.SetUniform1i("u_Indirection", slot + 1);
+	SetUniforms(shader, m_LodBias);
+}
+
+void VirtualTexture::SetUniforms(Shader& shader, float lodBias) const
+{
+	shader.SetUniform4f("u_VirtualParams", (float)GetWidth(), (float)GetHeight(), (float)(GetLevelCount() - 1), lodBias);
+	shader.SetUniform4f("u_PageParams", (float)m_File.GetPageContent(), (float)m_File.GetPageBorder(), (float)m_File.GetPageSize(), (float)GetCacheTextureSize());
+}
+
+void VirtualTexture::ResizeFeedback(int viewportWidth, int viewportHeight)
+{
+	const int width = std::max(1, viewportWidth / FeedbackDivisor);
+	const int height = std::max(1, viewportHeight / FeedbackDivisor);
+	if (m_FeedbackFramebuffer && width == m_FeedbackWidth && height == m_FeedbackHeight)
+	{
+		return;
+	}
+
+	if (!m_FeedbackFramebuffer)
+	{
+		GLCALL(glGenFramebuffers(1, &m_FeedbackFramebuffer));
+		GLCALL(glGenRenderbuffers(1, &m_FeedbackColor));
+		GLCALL(glGenRenderbuffers(1, &m_FeedbackDepth));
+	}
+	m_FeedbackWidth = width;
+	m_FeedbackHeight = height;
+
+	GLCALL(glBindRenderbuffer(GL_RENDERBUFFER, m_FeedbackColor));
+	GLCALL(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+	GLCALL(glBindRenderbuffer(GL_RENDERBUFFER, m_FeedbackDepth));
+	GLCALL(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height));
+	GLCALL(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, m_FeedbackFramebuffer));
+	GLCALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_FeedbackColor));
+	GLCALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_FeedbackDepth));
+	GLCALL(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Virtual texture feedback framebuffer is incomplete: " << status << std::endl;
+	}
+	GLCALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+
+	// The idle buffers have the old size
+	for (unsigned int buffer : m_FreeReadbackBuffers)
+	{
+		GLCALL(glDeleteBuffers(1, &buffer));
+		GLStateCache::OnBufferDeleted(buffer);
+	}
+	m_FreeReadbackBuffers.clear();
+}
+
+void VirtualTexture::ProcessFeedback(const unsigned char* pixels, unsigned int pixelCount)
+{
+	// Layout written by the feedback shader: low bytes of page x and y, their high nibbles, level + 1(0 where nothing was drawn)
+	std::unordered_set<PageKey> visible;
+	for (unsigned int i = 0; i < pixelCount; ++i)
+	{
+		const unsigned char* pixel = pixels + i * 4;
+		if (pixel[3] != 0)
+		{
+			const unsigned int x = pixel[0] | ((pixel[2] & 0xF) << 8);
+			const unsigned int y = pixel[1] | ((pixel[2] >> 4) << 8);
+			visible.insert(MakeKey(pixel[3] - 1, x, y));
+		}
+	}
+	m_Stats.VisiblePages = (unsigned int)visible.size();
+
+	// Ancestors are what gets shown while a page streams in, so they are kept too
+	std::unordered_set<PageKey> needed;
+	for (PageKey page : visible)
+	{
+		unsigned int x = GetX(page), y = GetY(page);
+		for (unsigned int level = GetLevel(page); level < m_File.GetLevelCount(); ++level, x >>= 1, y >>= 1)
+		{
+			if (!needed.insert(MakeKey(level, x, y)).second)
+			{
+				break;
+			}
+		}
+	}
+
+	// More pages than slots would evict each other every frame, step coarser until they fit and back finer once there is plenty of room
+	const unsigned int slotCount = m_CacheSize * m_CacheSize;
+	if (needed.size() > slotCount)
+	{
+		m_LodBias = std::min(m_LodBias + 0.5f, (float)(m_File.GetLevelCount() - 1));
+	}
+	else if (needed.size() * 2 < slotCount)
+	{
+		m_LodBias = std::max(m_LodBias - 0.25f, 0.f);
+	}
+	m_Stats.LodBias = m_LodBias;
+
+	// Coarse pages first, each of them improves a large area
+	std::vector<PageKey> requests(needed.begin(), needed.end());
+	std::sort(requests.begin(), requests.end(), [](PageKey a, PageKey b) { return GetLevel(a) > GetLevel(b); });
+	for (PageKey page : requests)
+	{
+		RequestPage(page);
+	}
+}
+
+void VirtualTexture::RequestPage(PageKey page)
+{
+	const unsigned int level = GetLevel(page);
+	if (level >= m_File.GetLevelCount() || GetX(page) >= m_File.GetPagesX(level) || GetY(page) >= m_File.GetPagesY(level))
+	{
+		return;
+	}
+
+	auto resident = m_ResidentPages.find(page);
+	if (resident != m_ResidentPages.end())
+	{
+		CacheSlot& slot = m_Slots[resident->second];
+		slot.LastUsedFrame = m_Frame;
+		if (level + 1 < m_File.GetLevelCount())
+		{
+			m_LeastRecentlyUsed.splice(m_LeastRecentlyUsed.begin(), m_LeastRecentlyUsed, slot.LRUPosition);
+		}
+		return;
+	}
+
+	if (m_PendingPages.size() >= MaxPendingPages || m_FailedPages.count(page) != 0 || !m_PendingPages.insert(page).second)
+	{
+		return;
+	}
+
+	m_Workers.Enqueue([this, page]()
+	{
+		LoadedPage loaded = { page, std::vector<unsigned char>(m_File.GetPageByteSize()) };
+		if (!m_File.ReadPage(GetLevel(page), GetX(page), GetY(page), loaded.Pixels.data()))
+		{
+			std::cout << "Failed to read virtual texture page " << GetX(page) << ", " << GetY(page) << " of level " << GetLevel(page) << "!" << std::endl;
+			loaded.Pixels.clear();
+		}
+
+		std::lock_guard<std::mutex> lock(m_LoadedMutex);
+		m_LoadedPages.push_back(std::move(loaded));
+	});
+}
+
+bool VirtualTexture::UploadPage(const LoadedPage& page)
+{
+	unsigned int slotIndex;
+	if (!m_FreeSlots.empty())
+	{
+		slotIndex = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		// Evicting a page which is on screen right now would only bring it back next frame
+		if (m_LeastRecentlyUsed.empty() || m_Slots[m_LeastRecentlyUsed.back()].LastUsedFrame == m_Frame)
+		{
+			return false;
+		}
+		slotIndex = m_LeastRecentlyUsed.back();
+		m_LeastRecentlyUsed.pop_back();
+		m_ResidentPages.erase(m_Slots[slotIndex].Page);
+		++m_Stats.EvictedPages;
+	}
+
+	CacheSlot& slot = m_Slots[slotIndex];
+	slot.Page = page.Page;
+	slot.LastUsedFrame = m_Frame;
+	if (GetLevel(page.Page) + 1 < m_File.GetLevelCount())
+	{
+		m_LeastRecentlyUsed.push_front(slotIndex);
+		slot.LRUPosition = m_LeastRecentlyUsed.begin();
+	}
+	m_ResidentPages[page.Page] = slotIndex;
+
+	const unsigned int pageSize = m_File.GetPageSize();
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_PageCache);
+	GLCALL(glTexSubImage2D(GL_TEXTURE_2D, 0, (slotIndex % m_CacheSize) * pageSize, (slotIndex / m_CacheSize) * pageSize, pageSize, pageSize, GL_RGBA, GL_UNSIGNED_BYTE, page.Pixels.data()));
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+
+	++m_Stats.UploadedPages;
+	m_bIndirectionDirty = true;
+	return true;
+}
+
+void VirtualTexture::UpdateIndirection()
+{
+	const unsigned int levelCount = m_File.GetLevelCount();
+	const unsigned int tableSize = m_File.GetPageTableSize();
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, m_Indirection);
+
+	// Coarse to fine, so a missing page can copy the entry of its parent
+	for (unsigned int level = levelCount; level-- > 0;)
+	{
+		const unsigned int size = tableSize >> level;
+		std::vector<unsigned char>& entries = m_IndirectionLevels[level];
+		const std::vector<unsigned char>* parent = level + 1 < levelCount ? &m_IndirectionLevels[level + 1] : nullptr;
+
+		const unsigned int pagesX = m_File.GetPagesX(level);
+		const unsigned int pagesY = m_File.GetPagesY(level);
+		for (unsigned int y = 0; y < pagesY; ++y)
+		{
+			for (unsigned int x = 0; x < pagesX; ++x)
+			{
+				unsigned char* entry = &entries[(y * size + x) * 4];
+				auto resident = m_ResidentPages.find(MakeKey(level, x, y));
+				if (resident != m_ResidentPages.end())
+				{
+					entry[0] = (unsigned char)(resident->second % m_CacheSize);
+					entry[1] = (unsigned char)(resident->second / m_CacheSize);
+					entry[2] = (unsigned char)level;
+					entry[3] = 255;
+				}
+				else if (parent)
+				{
+					memcpy(entry, &(*parent)[((y / 2) * (size / 2) + x / 2) * 4], 4);
+				}
+			}
+		}
+
+		GLCALL(glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, entries.data()));
+	}
+
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0, 0);
+	m_bIndirectionDirty = false;
+}
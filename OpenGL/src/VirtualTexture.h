@@ -0,0 +1,167 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Renderer.h"
+#include "ThreadPool.h"
+#include "VirtualTextureFile.h"
+
+class Shader;
+
+/**
+ * Streams an image of any size from its page file(see VirtualTextureFile) through a page cache of fixed size.
+ * Every frame the scene is drawn into a small feedback buffer first, which records the page each pixel wants to sample.
+ * The buffer is read back asynchronously, missing pages are read on worker threads and copied into the cache, the least recently used ones are evicted to make room.
+ * An indirection texture maps every page of every level to its cache slot, or to the slot of the closest coarser page while it is not resident,
+ * the last level is a single page which always stays in the cache, so there is something to show everywhere from the first frame on.
+ * GPU memory is bounded by the cache size and the indirection texture, regardless of how large the image is.
+ * Shaders sample it through res/shaders/include/VirtualTexture.glsl.
+ * Everything except reading the page file happens on the thread owning the GL context.
+ */
+class VirtualTexture
+{
+public:
+	struct Statistics
+	{
+		/** Pages in the cache, including the always resident last level. */
+		unsigned int ResidentPages = 0;
+		/** Requested pages not uploaded yet. */
+		unsigned int PendingPages = 0;
+		/** Distinct pages seen in the last feedback read back. */
+		unsigned int VisiblePages = 0;
+		/** Levels added to what the pixels would sample, while the visible pages do not fit into the cache. */
+		float LodBias = 0.f;
+		/** Totals since creation. */
+		unsigned int UploadedPages = 0;
+		unsigned int EvictedPages = 0;
+	};
+
+	/** The feedback buffer is this many times smaller than the viewport in both directions. */
+	static const int FeedbackDivisor = 8;
+
+public:
+	/**
+	 * @param cacheSize - Pages across and down the page cache, i.e. cacheSize squared pages are resident at most. Clamped to 255, slots are addressed with bytes.
+	 * @param uploadBudget - Pages copied into the cache per Update() at most.
+	 */
+	VirtualTexture(const std::string& pageFilePath, unsigned int cacheSize = 16, unsigned int uploadBudget = 16, unsigned int threadCount = 0);
+	~VirtualTexture();
+
+	/** Whether the page file could be opened, nothing is drawn otherwise. */
+	inline bool IsValid() const { return m_PageCache != 0; }
+
+	/**
+	 * Redirect rendering into the feedback buffer, the scene has to be drawn with the FEEDBACK variant of the shaders sampling this texture until EndFeedback().
+	 * Sets the uniforms of feedbackShader, which must be bound by then.
+	 */
+	void BeginFeedback(Shader& feedbackShader);
+	/** Restore the framebuffer and start reading the feedback back, without waiting for it. */
+	void EndFeedback();
+
+	/** Call once per frame: request the pages of finished feedback, copy loaded pages into the cache and update the indirection texture. */
+	void Update();
+
+	/** Bind the page cache and the indirection texture to slot and slot + 1 and set the uniforms of shader, which must be bound. */
+	void Bind(Shader& shader, unsigned int slot = 0) const;
+
+	inline int GetWidth() const { return m_File.GetWidth(); }
+	inline int GetHeight() const { return m_File.GetHeight(); }
+	inline unsigned int GetLevelCount() const { return m_File.GetLevelCount(); }
+	/** Side of the page cache texture in pixels. */
+	inline unsigned int GetCacheTextureSize() const { return m_CacheSize * m_File.GetPageSize(); }
+	inline const Statistics& GetStats() const { return m_Stats; }
+
+private:
+	/** Level, x and y of a page packed into one key. */
+	typedef unsigned int PageKey;
+	static PageKey MakeKey(unsigned int level, unsigned int x, unsigned int y) { return (level << 26) | (y << 13) | x; }
+	static unsigned int GetLevel(PageKey key) { return key >> 26; }
+	static unsigned int GetX(PageKey key) { return key & 0x1FFF; }
+	static unsigned int GetY(PageKey key) { return (key >> 13) & 0x1FFF; }
+
+	struct CacheSlot
+	{
+		PageKey Page;
+		/** Position in m_LeastRecentlyUsed, only for evictable slots. */
+		std::list<unsigned int>::iterator LRUPosition;
+		unsigned int LastUsedFrame;
+	};
+
+	struct LoadedPage
+	{
+		PageKey Page;
+		std::vector<unsigned char> Pixels;
+	};
+
+	struct FeedbackReadback
+	{
+		unsigned int PixelBuffer;
+		unsigned int PixelCount;
+		GLsync Fence;
+	};
+
+	/** Uniforms shared by both passes, lodBias makes the feedback pass request the levels the full resolution pass samples. */
+	void SetUniforms(Shader& shader, float lodBias) const;
+	/** (Re)create the feedback buffer if the viewport size changed. */
+	void ResizeFeedback(int viewportWidth, int viewportHeight);
+	/** Decode a finished read back into page requests, the ancestors of visible pages are kept resident too. */
+	void ProcessFeedback(const unsigned char* pixels, unsigned int pixelCount);
+	/** Mark a resident page as used this frame, or queue it for loading. */
+	void RequestPage(PageKey page);
+	/** Copy a page into a free or evicted cache slot, false if every slot is in use this frame. */
+	bool UploadPage(const LoadedPage& page);
+	/** Rebuild every level of the indirection texture, cheap enough to do whenever a page comes or goes. */
+	void UpdateIndirection();
+
+private:
+	VirtualTextureFile m_File;
+	unsigned int m_CacheSize;
+	unsigned int m_UploadBudget;
+	unsigned int m_Frame;
+	/** Added to the level of both passes, see ProcessFeedback(). */
+	float m_LodBias;
+
+	unsigned int m_PageCache;
+	unsigned int m_Indirection;
+	/** CPU copy of every indirection level: cache slot x, y, level of the page shown and 255. */
+	std::vector<std::vector<unsigned char>> m_IndirectionLevels;
+	bool m_bIndirectionDirty;
+
+	std::vector<CacheSlot> m_Slots;
+	std::vector<unsigned int> m_FreeSlots;
+	/** Evictable slots, most recently used at the front. The slot of the last level is not in here. */
+	std::list<unsigned int> m_LeastRecentlyUsed;
+	std::unordered_map<PageKey, unsigned int> m_ResidentPages;
+	/** Queued or being read by a worker, at most MaxPendingPages. */
+	std::unordered_set<PageKey> m_PendingPages;
+	/** Failed to read, never requested again. Kept apart so they do not hold up streaming the others. */
+	std::unordered_set<PageKey> m_FailedPages;
+
+	unsigned int m_FeedbackFramebuffer;
+	unsigned int m_FeedbackColor;
+	unsigned int m_FeedbackDepth;
+	int m_FeedbackWidth, m_FeedbackHeight;
+	/** Read backs in flight, oldest first. */
+	std::list<FeedbackReadback> m_Readbacks;
+	/** Pixel buffers of the current feedback size which are not in use. */
+	std::vector<unsigned int> m_FreeReadbackBuffers;
+	/** State replaced during the feedback pass. */
+	int m_SavedViewport[4];
+	float m_SavedClearColor[4];
+	bool m_bSavedBlend;
+
+	/** Filled by the workers. */
+	std::vector<LoadedPage> m_LoadedPages;
+	std::mutex m_LoadedMutex;
+
+	Statistics m_Stats;
+
+	/** Declared last, so the workers are joined before the members they use are destroyed. */
+	ThreadPool m_Workers;
+
+};
@@ -0,0 +1,147 @@
+#include "VirtualTextureFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "MipmapGenerator.h"
+
+VirtualTextureFile::VirtualTextureFile()
+	: m_Header()
+{
+}
+
+VirtualTextureFile::~VirtualTextureFile()
+{
+}
+
+unsigned int VirtualTextureFile::GetLevelCount(int width, int height, unsigned int pageContent)
+{
+	const unsigned int pages = (unsigned int)std::max((width + pageContent - 1) / pageContent, (height + pageContent - 1) / pageContent);
+	unsigned int levelCount = 1;
+	while ((1u << (levelCount - 1)) < pages)
+	{
+		++levelCount;
+	}
+	return levelCount;
+}
+
+bool VirtualTextureFile::Build(const unsigned char* pixels, int width, int height, const std::string& filePath, unsigned int pageContent, unsigned int pageBorder)
+{
+	std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+	const Header header = { CurrentMagic, CurrentVersion, width, height, pageContent, pageBorder, GetLevelCount(width, height, pageContent) };
+	stream.write((const char*)&header, sizeof(header));
+
+	const int pageSize = (int)(pageContent + 2 * pageBorder);
+	std::vector<unsigned char> page(pageSize * pageSize * 4);
+	std::vector<unsigned char> level, nextLevel;
+	const unsigned char* levelPixels = pixels;
+	int levelWidth = width, levelHeight = height;
+	for (unsigned int levelIndex = 0; levelIndex < header.LevelCount; ++levelIndex)
+	{
+		const int pagesX = (levelWidth + pageContent - 1) / pageContent;
+		const int pagesY = (levelHeight + pageContent - 1) / pageContent;
+		for (int pageY = 0; pageY < pagesY; ++pageY)
+		{
+			for (int pageX = 0; pageX < pagesX; ++pageX)
+			{
+				// The border repeats the edge pixels where the level ends
+				const int left = pageX * (int)pageContent - (int)pageBorder;
+				const int bottom = pageY * (int)pageContent - (int)pageBorder;
+				for (int row = 0; row < pageSize; ++row)
+				{
+					const int srcY = std::min(std::max(bottom + row, 0), levelHeight - 1);
+					const unsigned char* src = levelPixels + (size_t)srcY * levelWidth * 4;
+					unsigned char* dst = &page[row * pageSize * 4];
+					for (int column = 0; column < pageSize; ++column)
+					{
+						const int srcX = std::min(std::max(left + column, 0), levelWidth - 1);
+						memcpy(dst + column * 4, src + srcX * 4, 4);
+					}
+				}
+				stream.write((const char*)page.data(), page.size());
+			}
+		}
+
+		if (levelIndex + 1 < header.LevelCount)
+		{
+			nextLevel.resize((size_t)std::max(1, levelWidth / 2) * std::max(1, levelHeight / 2) * 4);
+			MipmapGenerator::Downsample(levelPixels, levelWidth, levelHeight, nextLevel.data());
+			level.swap(nextLevel);
+			levelPixels = level.data();
+			levelWidth = std::max(1, levelWidth / 2);
+			levelHeight = std::max(1, levelHeight / 2);
+		}
+	}
+
+	if (!stream)
+	{
+		std::cout << "Failed to write '" << filePath << "'!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool VirtualTextureFile::Open(const std::string& filePath)
+{
+	m_Stream.open(filePath, std::ios::binary);
+	if (!m_Stream.read((char*)&m_Header, sizeof(m_Header)) || m_Header.Magic != CurrentMagic)
+	{
+		std::cout << "'" << filePath << "' is not a virtual texture page file!" << std::endl;
+		m_Stream.close();
+		return false;
+	}
+	if (m_Header.Version != CurrentVersion)
+	{
+		std::cout << "'" << filePath << "' is version " << m_Header.Version << ", expected " << CurrentVersion << ", build it again!" << std::endl;
+		m_Stream.close();
+		return false;
+	}
+
+	m_LevelFirstPage.clear();
+	unsigned long long pageCount = 0;
+	for (unsigned int level = 0; level < m_Header.LevelCount; ++level)
+	{
+		m_LevelFirstPage.push_back(pageCount);
+		pageCount += (unsigned long long)GetPagesX(level) * GetPagesY(level);
+	}
+
+	// A truncated file would only show up as failing pages much later
+	m_Stream.seekg(0, std::ios::end);
+	if ((unsigned long long)m_Stream.tellg() < sizeof(Header) + pageCount * GetPageByteSize())
+	{
+		std::cout << "'" << filePath << "' is truncated, build it again!" << std::endl;
+		m_Stream.close();
+		return false;
+	}
+	return true;
+}
+
+bool VirtualTextureFile::ReadPage(unsigned int level, unsigned int x, unsigned int y, unsigned char* dst)
+{
+	if (level >= m_Header.LevelCount || x >= GetPagesX(level) || y >= GetPagesY(level))
+	{
+		return false;
+	}
+
+	const unsigned long long page = m_LevelFirstPage[level] + (unsigned long long)y * GetPagesX(level) + x;
+	const unsigned long long offset = sizeof(Header) + page * GetPageByteSize();
+
+	std::lock_guard<std::mutex> lock(m_StreamMutex);
+	// A failed read must not break the following ones
+	m_Stream.clear();
+	m_Stream.seekg((std::streamoff)offset);
+	return (bool)m_Stream.read((char*)dst, GetPageByteSize());
+}
+
+unsigned int VirtualTextureFile::GetPagesX(unsigned int level) const
+{
+	const unsigned int width = (unsigned int)std::max(1, m_Header.Width >> level);
+	return (width + m_Header.PageContent - 1) / m_Header.PageContent;
+}
+
+unsigned int VirtualTextureFile::GetPagesY(unsigned int level) const
+{
+	const unsigned int height = (unsigned int)std::max(1, m_Header.Height >> level);
+	return (height + m_Header.PageContent - 1) / m_Header.PageContent;
+}
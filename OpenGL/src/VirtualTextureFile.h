@@ -0,0 +1,79 @@
+#pragma once
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Page file of a VirtualTexture: the image and all its mip levels cut into square RGBA8 pages, so any page can be read without touching the rest.
+ * Every page holds PageContent x PageContent pixels of the level surrounded by a border of neighbouring pixels(the edge pixels where the level ends),
+ * so a page sampled bilinearly inside the page cache never pulls in its neighbour in the cache.
+ * Level l is max(1, width >> l) x max(1, height >> l) like a GL mip level, the last level fits on a single page.
+ * Pure file handling without GL, used by VirtualTexture and by the offline TextureCompressor.
+ */
+class VirtualTextureFile
+{
+public:
+	static const unsigned int DefaultPageContent = 120;
+	static const unsigned int DefaultPageBorder = 4;
+
+public:
+	VirtualTextureFile();
+	~VirtualTextureFile();
+
+	/**
+	 * Cut an image into pages and write the page file, levels are built one after another so at most 1.25 times the image is held in memory.
+	 * @param pixels - Tightly packed RGBA8, the first row is the bottom one.
+	 */
+	static bool Build(const unsigned char* pixels, int width, int height, const std::string& filePath,
+		unsigned int pageContent = DefaultPageContent, unsigned int pageBorder = DefaultPageBorder);
+
+	/** Read the header, pages are read on demand afterwards. */
+	bool Open(const std::string& filePath);
+	inline bool IsOpen() const { return m_Stream.is_open(); }
+
+	/** Read one page into dst, which has to hold GetPageByteSize() bytes. Can be called from any thread. */
+	bool ReadPage(unsigned int level, unsigned int x, unsigned int y, unsigned char* dst);
+
+	inline int GetWidth() const { return m_Header.Width; }
+	inline int GetHeight() const { return m_Header.Height; }
+	inline unsigned int GetLevelCount() const { return m_Header.LevelCount; }
+	inline unsigned int GetPageContent() const { return m_Header.PageContent; }
+	inline unsigned int GetPageBorder() const { return m_Header.PageBorder; }
+	/** Side of a page including the border on both sides. */
+	inline unsigned int GetPageSize() const { return m_Header.PageContent + 2 * m_Header.PageBorder; }
+	inline unsigned int GetPageByteSize() const { return GetPageSize() * GetPageSize() * 4; }
+	/** Pages across and down level 0 rounded up to a power of two, a mip chain of this size has room for the pages of every level. */
+	inline unsigned int GetPageTableSize() const { return 1u << (m_Header.LevelCount - 1); }
+
+	unsigned int GetPagesX(unsigned int level) const;
+	unsigned int GetPagesY(unsigned int level) const;
+
+private:
+	struct Header
+	{
+		unsigned int Magic;
+		unsigned int Version;
+		int Width, Height;
+		unsigned int PageContent;
+		unsigned int PageBorder;
+		unsigned int LevelCount;
+	};
+
+	static const unsigned int CurrentMagic = 0x58455456; // "VTEX"
+	static const unsigned int CurrentVersion = 1;
+
+	/** Levels needed so the last one fits on a single page. */
+	static unsigned int GetLevelCount(int width, int height, unsigned int pageContent);
+
+private:
+	Header m_Header;
+	/** Index of the first page of every level, pages are stored level by level in rows. */
+	std::vector<unsigned long long> m_LevelFirstPage;
+
+	std::ifstream m_Stream;
+	/** Seeking and reading must not interleave between threads. */
+	std::mutex m_StreamMutex;
+
+};
@@ -4,6 +4,8 @@
 #include <string>
 #include <functional>
 
+class CommandList;
+
 namespace test
 {
 	class Test
@@ -14,6 +16,11 @@ namespace test
 
 		virtual void OnUpdate(float deltaTime) {}
 		virtual void OnRender() {}
+		/**
+		 * Record rendering into commandList instead of calling GL directly, so that it can be executed later on the render thread.
+		 * Return false if the test can only render via OnRender().
+		 */
+		virtual bool OnRecordRender(CommandList& commandList) { return false; }
 		virtual void OnImGuiRender() {}
 
 	};
@@ -0,0 +1,79 @@
+#include "Test_AsyncTextures.h"
+
+#include <chrono>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_AsyncTextures::Test_AsyncTextures()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_bReloadRequested(false)
+		, m_bAsync(true)
+		, m_ReloadTime(0.0)
+	{
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_Renderer2D.reset(new Renderer2D());
+		m_Loader.reset(new TextureLoader());
+		ReloadTextures(true);
+	}
+
+	void Test_AsyncTextures::ReloadTextures(bool bAsync)
+	{
+		const char* files[] = { "res/textures/Logo_Trans.png", "res/textures/Logo.png" };
+
+		auto start = std::chrono::high_resolution_clock::now();
+		m_Textures.clear();
+		// Every quad gets a texture of its own, as a scene with hundreds of distinct textures would
+		for (int i = 0; i < GridSize * GridSize; ++i)
+		{
+			const char* file = files[i % 2];
+			m_Textures.push_back(bAsync ? m_Loader->Load(file) : std::make_shared<Texture>(file));
+		}
+		m_ReloadTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void Test_AsyncTextures::OnRender()
+	{
+		if (m_bReloadRequested)
+		{
+			ReloadTextures(m_bAsync);
+			m_bReloadRequested = false;
+		}
+		m_Loader->Update();
+
+		m_Renderer2D->ResetStats();
+		m_Renderer2D->BeginBatch(m_Proj * m_View);
+
+		const glm::vec2 quadSize(WINDOW_WIDTH / GridSize, WINDOW_HEIGHT / GridSize);
+		for (int y = 0; y < GridSize; ++y)
+		{
+			for (int x = 0; x < GridSize; ++x)
+			{
+				glm::vec3 position((x + 0.5f) * quadSize.x, (y + 0.5f) * quadSize.y, 0.f);
+				m_Renderer2D->DrawQuad(position, quadSize * 0.9f, *m_Textures[y * GridSize + x]);
+			}
+		}
+
+		m_Renderer2D->EndBatch();
+	}
+
+	void Test_AsyncTextures::OnImGuiRender()
+	{
+		ImGui::Checkbox("Asynchronous", &m_bAsync);
+		if (ImGui::Button("Reload Textures"))
+		{
+			m_bReloadRequested = true;
+		}
+		ImGui::Text("Textures: %d, still loading: %u", GridSize * GridSize, m_Loader->GetPendingCount());
+		ImGui::Text("Frame blocked by reload for %.3f ms", m_ReloadTime);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+}
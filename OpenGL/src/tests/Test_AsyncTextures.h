@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "Renderer2D.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_AsyncTextures : public Test
+	{
+	public:
+		Test_AsyncTextures();
+		~Test_AsyncTextures() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Replace every texture, decoding them on the calling thread or through the loader. */
+		void ReloadTextures(bool bAsync);
+
+	private:
+		static const int GridSize = 16;
+
+		std::unique_ptr<Renderer2D> m_Renderer2D;
+		std::unique_ptr<TextureLoader> m_Loader;
+		std::vector<std::shared_ptr<Texture>> m_Textures;
+
+		glm::mat4 m_Proj, m_View;
+		/** Set by the UI, handled in OnRender() which runs on the thread owning the GL context. */
+		bool m_bReloadRequested;
+		bool m_bAsync;
+		/** Time spent inside the last reload, i.e. how long the frame was blocked. */
+		double m_ReloadTime;
+	};
+
+}
@@ -0,0 +1,83 @@
+#include "Test_BatchRendering.h"
+
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "ResourceCache.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_BatchRendering::Test_BatchRendering()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_GridSize(100)
+		, m_bUseTexture(true)
+		, m_MipmapMode((int)MipmapMode::GPU)
+		, m_Anisotropy(1.f)
+		// A GL query, which OnImGuiRender() must not make, it runs without a context with --render-thread
+		, m_MaxAnisotropy(Texture::GetMaxAnisotropy())
+	{
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_Renderer2D.reset(new Renderer2D());
+		m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png", m_TextureOptions);
+	}
+
+	void Test_BatchRendering::OnRender()
+	{
+		if (m_TextureOptions.Mipmaps != (MipmapMode)m_MipmapMode)
+		{
+			m_TextureOptions.Mipmaps = (MipmapMode)m_MipmapMode;
+			m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png", m_TextureOptions);
+			// A cached texture keeps the anisotropy it was last given
+			m_TextureOptions.Anisotropy = 0.f;
+		}
+		if (m_TextureOptions.Anisotropy != m_Anisotropy)
+		{
+			// Sampling state only, the texture stays the same
+			m_TextureOptions.Anisotropy = m_Anisotropy;
+			m_Texture->SetAnisotropy(m_Anisotropy);
+		}
+
+		m_Renderer2D->ResetStats();
+		m_Renderer2D->BeginBatch(m_Proj * m_View);
+
+		// Fill the window with a grid of quads, all of them will be submitted in as few draw calls as possible
+		const glm::vec2 quadSize(WINDOW_WIDTH / m_GridSize, WINDOW_HEIGHT / m_GridSize);
+		for (int y = 0; y < m_GridSize; ++y)
+		{
+			for (int x = 0; x < m_GridSize; ++x)
+			{
+				glm::vec3 position((x + 0.5f) * quadSize.x, (y + 0.5f) * quadSize.y, 0.f);
+				glm::vec4 color((float)x / m_GridSize, 0.2f, (float)y / m_GridSize, 1.f);
+				if (m_bUseTexture && (x + y) % 2 == 0)
+				{
+					m_Renderer2D->DrawQuad(position, quadSize * 0.9f, *m_Texture, color);
+				}
+				else
+				{
+					m_Renderer2D->DrawQuad(position, quadSize * 0.9f, color);
+				}
+			}
+		}
+
+		m_Renderer2D->EndBatch();
+	}
+
+	void Test_BatchRendering::OnImGuiRender()
+	{
+		ImGui::SliderInt("Grid Size", &m_GridSize, 1, 300);
+		ImGui::Checkbox("Use Texture", &m_bUseTexture);
+		ImGui::Combo("Mipmaps", &m_MipmapMode, "None\0GPU(glGenerateMipmap)\0CPU(SSE2 box filter)\0");
+		ImGui::SliderFloat("Anisotropy", &m_Anisotropy, 1.f, m_MaxAnisotropy);
+		const Renderer2D::Statistics& stats = m_Renderer2D->GetStats();
+		ImGui::Text("Quads: %u, Draw Calls: %u", stats.QuadCount, stats.DrawCalls);
+		const GLStateCache::Statistics& stateStats = GLStateCache::GetStats();
+		ImGui::Text("GL bind calls issued: %u, skipped: %u", stateStats.IssuedCalls, stateStats.SkippedCalls);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+
+#include "Renderer2D.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_BatchRendering : public Test
+	{
+	public:
+		Test_BatchRendering();
+		~Test_BatchRendering() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		std::unique_ptr<Renderer2D> m_Renderer2D;
+		std::shared_ptr<Texture> m_Texture;
+
+		glm::mat4 m_Proj, m_View;
+		int m_GridSize;
+		bool m_bUseTexture;
+		/** Index into MipmapMode, with many quads the texture is heavily minified. */
+		int m_MipmapMode;
+		float m_Anisotropy;
+		float m_MaxAnisotropy;
+		/** Options applied to the current texture, a new mipmap mode gets another texture in OnRender(), a new anisotropy changes this one. */
+		TextureOptions m_TextureOptions;
+	};
+
+}
@@ -1,6 +1,7 @@
 #include "Test_ClearColor.h"
 
 #include "Renderer.h"
+#include "CommandList.h"
 #include "imgui/imgui.h"
 
 namespace test
@@ -16,6 +17,12 @@ namespace test
 		GLCALL(glClear(GL_COLOR_BUFFER_BIT));
 	}
 
+	bool Test_ClearColor::OnRecordRender(CommandList& commandList)
+	{
+		commandList.Clear(glm::vec4(m_ClearColor[0], m_ClearColor[1], m_ClearColor[2], m_ClearColor[3]));
+		return true;
+	}
+
 	void Test_ClearColor::OnImGuiRender()
 	{
 		ImGui::ColorEdit4("Clear Color", m_ClearColor);
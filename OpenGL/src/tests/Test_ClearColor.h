@@ -11,6 +11,7 @@ namespace test
 		~Test_ClearColor() {}
 
 		virtual void OnRender() override;
+		virtual bool OnRecordRender(CommandList& commandList) override;
 		virtual void OnImGuiRender() override;
 
 	private:
@@ -0,0 +1,154 @@
+#include "Test_CommandLists.h"
+
+#include <chrono>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "VertexBufferLayout.h"
+#include "ResourceCache.h"
+#include "UniformBuffer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_CommandLists::Test_CommandLists()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_GridSize(30)
+		, m_bMultithreaded(true)
+		, m_RecordTime(0.f)
+	{
+		// Unit quad, each draw scales and moves it with its own MVP
+		float positions[] = {
+			-0.5f, -0.5f, 0.f, 0.f, // 0
+			 0.5f, -0.5f, 1.f, 0.f, // 1
+			 0.5f,  0.5f, 1.f, 1.f, // 2
+			-0.5f,  0.5f, 0.f, 1.f  // 3
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_VAO.reset(new VertexArray());
+		m_VBO.reset(new VertexBuffer(positions, 4 * 4 * sizeof(float)));
+		VertexBufferLayout layout;
+		// Vertex position
+		layout.Push<float>(2);
+		// Texture coordinate
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+
+		m_IBO.reset(new IndexBuffer(indices, 6));
+
+		m_Shader = ResourceCache::GetShader("res/shaders/Basic.shader");
+		m_Shader->Bind();
+		m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png");
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_ThreadPool.reset(new ThreadPool());
+		for (unsigned int i = 0; i < m_ThreadPool->GetThreadCount(); ++i)
+		{
+			m_CommandLists.emplace_back(new CommandList());
+		}
+		m_UniformRing.reset(new UniformRing(4 * 1024 * 1024));
+	}
+
+	void Test_CommandLists::OnRender()
+	{
+		const int listCount = RecordGrid();
+
+		// Replay in list order on the GL thread
+		Renderer renderer;
+		m_UniformRing->BeginFrame();
+		for (int i = 0; i < listCount; ++i)
+		{
+			m_CommandLists[i]->Execute(renderer, m_UniformRing.get());
+		}
+		m_UniformRing->EndFrame();
+	}
+
+	bool Test_CommandLists::OnRecordRender(CommandList& commandList)
+	{
+		const int listCount = RecordGrid();
+
+		// Merge into the frame's list, the per-worker lists will be reused next frame while this one is still being rendered
+		for (int i = 0; i < listCount; ++i)
+		{
+			commandList.Append(*m_CommandLists[i]);
+		}
+		return true;
+	}
+
+	void Test_CommandLists::OnImGuiRender()
+	{
+		ImGui::SliderInt("Grid Size", &m_GridSize, 1, 200);
+		ImGui::Checkbox("Record on worker threads", &m_bMultithreaded);
+		ImGui::Text("Worker threads: %u, recording: %.3f ms", m_ThreadPool->GetThreadCount(), m_RecordTime);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+
+	int Test_CommandLists::RecordGrid()
+	{
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		const int listCount = m_bMultithreaded ? (int)m_CommandLists.size() : 1;
+		const int rowsPerList = (m_GridSize + listCount - 1) / listCount;
+		for (int i = 0; i < listCount; ++i)
+		{
+			CommandList* commandList = m_CommandLists[i].get();
+			commandList->Reset();
+			const int beginRow = i * rowsPerList;
+			const int endRow = beginRow + rowsPerList < m_GridSize ? beginRow + rowsPerList : m_GridSize;
+			if (m_bMultithreaded)
+			{
+				m_ThreadPool->Enqueue([this, commandList, beginRow, endRow]() { RecordRows(*commandList, beginRow, endRow); });
+			}
+			else
+			{
+				RecordRows(*commandList, beginRow, endRow);
+			}
+		}
+		m_ThreadPool->Wait();
+
+		m_RecordTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		return listCount;
+	}
+
+	void Test_CommandLists::RecordRows(CommandList& commandList, int beginRow, int endRow) const
+	{
+		if (beginRow >= endRow)
+		{
+			return;
+		}
+
+		commandList.BindPipeline(*m_Shader, *m_VAO, *m_IBO);
+		commandList.BindTexture(*m_Texture);
+
+		// Every list may be executed on its own, so each one carries the frame data
+		unsigned char frameData[FrameBlockLayout::GetSize()];
+		FrameBlockLayout::Write<0>(frameData, m_Proj * m_View);
+		commandList.SetUniformBlock(FrameBlockBinding, frameData, sizeof(frameData));
+
+		unsigned char objectData[ObjectBlockLayout::GetSize()];
+		const glm::vec2 cellSize(WINDOW_WIDTH / m_GridSize, WINDOW_HEIGHT / m_GridSize);
+		for (int y = beginRow; y < endRow; ++y)
+		{
+			for (int x = 0; x < m_GridSize; ++x)
+			{
+				glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3((x + 0.5f) * cellSize.x, (y + 0.5f) * cellSize.y, 0.f));
+				model = glm::scale(model, glm::vec3(cellSize * 0.9f, 1.f));
+				ObjectBlockLayout::Write<0>(objectData, model);
+				commandList.SetUniformBlock(ObjectBlockBinding, objectData, sizeof(objectData));
+				commandList.DrawIndexed();
+			}
+		}
+	}
+}
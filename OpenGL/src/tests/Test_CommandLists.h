@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "CommandList.h"
+#include "ThreadPool.h"
+#include "UniformRing.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_CommandLists : public Test
+	{
+	public:
+		Test_CommandLists();
+		~Test_CommandLists() {}
+
+		virtual void OnRender() override;
+		virtual bool OnRecordRender(CommandList& commandList) override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Record the whole grid into the per-worker lists and return how many of them are used. */
+		int RecordGrid();
+		/** Record draws of the quads in rows [beginRow, endRow) of the grid. */
+		void RecordRows(CommandList& commandList, int beginRow, int endRow) const;
+
+	private:
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+
+		std::unique_ptr<ThreadPool> m_ThreadPool;
+		/** One list per worker so that recording needs no synchronization. */
+		std::vector<std::unique_ptr<CommandList>> m_CommandLists;
+		/** Backs the uniform blocks recorded into the lists when they are executed by OnRender(). */
+		std::unique_ptr<UniformRing> m_UniformRing;
+
+		glm::mat4 m_Proj, m_View;
+		int m_GridSize;
+		bool m_bMultithreaded;
+		float m_RecordTime;
+	};
+
+}
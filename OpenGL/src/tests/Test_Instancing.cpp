@@ -0,0 +1,110 @@
+#include "Test_Instancing.h"
+
+#include <cmath>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "VertexBufferLayout.h"
+#include "ResourceCache.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_Instancing::Test_Instancing()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_InstanceCount(2)
+		, m_UploadedInstanceCount(0)
+	{
+		// Unit quad, every instance scales and moves it with its own model matrix
+		float positions[] = {
+			-0.5f, -0.5f, 0.f, 0.f, // 0
+			 0.5f, -0.5f, 1.f, 0.f, // 1
+			 0.5f,  0.5f, 1.f, 1.f, // 2
+			-0.5f,  0.5f, 0.f, 1.f  // 3
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_VAO.reset(new VertexArray());
+
+		m_VBO.reset(new VertexBuffer(positions, 4 * 4 * sizeof(float)));
+		VertexBufferLayout layout;
+		// Vertex position
+		layout.Push<float>(2);
+		// Texture coordinate
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+
+		m_InstanceVBO.reset(new VertexBuffer(MaxInstances * sizeof(glm::mat4), BufferUsage::Stream));
+		VertexBufferLayout instanceLayout;
+		// Model matrix, one column per attribute, advancing once per instance
+		instanceLayout.Push<float>(4, 1);
+		instanceLayout.Push<float>(4, 1);
+		instanceLayout.Push<float>(4, 1);
+		instanceLayout.Push<float>(4, 1);
+		m_VAO->AddBuffer(*m_InstanceVBO, instanceLayout);
+
+		m_IBO.reset(new IndexBuffer(indices, 6));
+
+		m_Shader = ResourceCache::GetShader("res/shaders/Instanced.shader");
+		m_Shader->Bind();
+
+		m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png");
+		m_Texture->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_InstanceTransforms.reserve(MaxInstances);
+	}
+
+	void Test_Instancing::OnRender()
+	{
+		if (m_InstanceCount != m_UploadedInstanceCount)
+		{
+			UpdateInstanceTransforms();
+		}
+
+		Renderer renderer;
+
+		m_Texture->Bind();
+		m_Shader->Bind();
+		// The view projection matrix is shared by all instances, so it is set only once per frame
+		m_Shader->SetUniformMat4f("u_ViewProj", m_Proj * m_View);
+		renderer.DrawInstanced(*m_VAO, *m_IBO, *m_Shader, m_InstanceCount);
+	}
+
+	void Test_Instancing::OnImGuiRender()
+	{
+		ImGui::SliderInt("Instance Count", &m_InstanceCount, 1, MaxInstances);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+
+	void Test_Instancing::UpdateInstanceTransforms()
+	{
+		const int columns = (int)std::ceil(std::sqrt((float)m_InstanceCount));
+		const float cellSize = WINDOW_HEIGHT / columns;
+
+		m_InstanceTransforms.clear();
+		for (int i = 0; i < m_InstanceCount; ++i)
+		{
+			glm::vec3 position((i % columns + 0.5f) * cellSize, (i / columns + 0.5f) * cellSize, 0.f);
+			glm::mat4 model = glm::translate(glm::mat4(1.f), position);
+			model = glm::scale(model, glm::vec3(cellSize * 0.9f, cellSize * 0.9f, 1.f));
+			m_InstanceTransforms.push_back(model);
+		}
+
+		// The whole range is rewritten, so hand the previous store back to the driver instead of waiting on it
+		m_InstanceVBO->Orphan();
+		m_InstanceVBO->SetData(0, m_InstanceTransforms.data(), (unsigned int)(m_InstanceTransforms.size() * sizeof(glm::mat4)));
+		m_UploadedInstanceCount = m_InstanceCount;
+	}
+}
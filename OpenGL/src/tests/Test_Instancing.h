@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_Instancing : public Test
+	{
+	public:
+		Test_Instancing();
+		~Test_Instancing() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Lay out the instances on a grid and upload their model matrices. */
+		void UpdateInstanceTransforms();
+
+	private:
+		static const int MaxInstances = 10000;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		/** Per-instance model matrices. */
+		std::unique_ptr<VertexBuffer> m_InstanceVBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+
+		std::vector<glm::mat4> m_InstanceTransforms;
+
+		glm::mat4 m_Proj, m_View;
+		int m_InstanceCount;
+		int m_UploadedInstanceCount;
+	};
+
+}
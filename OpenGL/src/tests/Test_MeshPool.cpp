@@ -0,0 +1,135 @@
+#include "Test_MeshPool.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include "ResourceCache.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_MeshPool::Test_MeshPool()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_ChurnPerFrame(10)
+		, m_MovesPerFrame(4)
+		, m_MovedLastFrame(0)
+	{
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		VertexBufferLayout layout;
+		// Vertex position
+		layout.Push<float>(2);
+		// Texture coordinate
+		layout.Push<float>(2);
+		// Start small on purpose so that the pool has to grow, polygons are tiny so 16-bit indices are plenty
+		m_MeshPool.reset(new MeshPool(layout, 4096, 4096 * 3, GL_UNSIGNED_SHORT));
+
+		m_ObjectVBO.reset(new VertexBuffer(ObjectCount * sizeof(glm::mat4), BufferUsage::Stream));
+		VertexBufferLayout objectLayout;
+		// Model matrix, fetched at gl_InstanceID + base instance
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		m_MeshPool->GetVertexArray().AddBuffer(*m_ObjectVBO, objectLayout);
+
+		m_IndirectBuffer.reset(new IndirectBuffer());
+
+		m_Shader = ResourceCache::GetShader("res/shaders/Instanced.shader");
+		m_Shader->Bind();
+
+		m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png");
+		m_Texture->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		const int columns = (int)std::ceil(std::sqrt((float)ObjectCount));
+		const float cellSize = WINDOW_HEIGHT / columns;
+		for (int i = 0; i < ObjectCount; ++i)
+		{
+			m_Objects.push_back(AddRandomMesh());
+
+			glm::vec3 position((i % columns + 0.5f) * cellSize, (i / columns + 0.5f) * cellSize, 0.f);
+			glm::mat4 model = glm::translate(glm::mat4(1.f), position);
+			model = glm::scale(model, glm::vec3(cellSize * 0.9f, cellSize * 0.9f, 1.f));
+			m_ObjectTransforms.push_back(model);
+		}
+		m_ObjectVBO->SetData(0, m_ObjectTransforms.data(), (unsigned int)(m_ObjectTransforms.size() * sizeof(glm::mat4)));
+	}
+
+	void Test_MeshPool::OnRender()
+	{
+		// Replace random meshes with ones of a different size, which leaves holes behind
+		// Done here rather than in OnUpdate() as it touches GL, which may live on the render thread
+		for (int i = 0; i < m_ChurnPerFrame; ++i)
+		{
+			MeshPool::MeshHandle& object = m_Objects[rand() % ObjectCount];
+			m_MeshPool->RemoveMesh(object);
+			object = AddRandomMesh();
+		}
+
+		m_MovedLastFrame = m_MeshPool->Defragment(m_MovesPerFrame);
+
+		// Ranges change with every add and move, the commands are cheap enough to be rebuilt every frame
+		m_IndirectBuffer->Clear();
+		for (int i = 0; i < ObjectCount; ++i)
+		{
+			m_MeshPool->AddDraw(*m_IndirectBuffer, m_Objects[i], i);
+		}
+		m_IndirectBuffer->Upload();
+
+		Renderer renderer;
+
+		m_Texture->Bind();
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f("u_ViewProj", m_Proj * m_View);
+		renderer.MultiDrawIndirect(m_MeshPool->GetVertexArray(), m_MeshPool->GetIndexBuffer(), *m_Shader, *m_IndirectBuffer);
+	}
+
+	void Test_MeshPool::OnImGuiRender()
+	{
+		const FreeListAllocator& vertices = m_MeshPool->GetVertexAllocator();
+		const FreeListAllocator& indices = m_MeshPool->GetIndexAllocator();
+
+		ImGui::SliderInt("Meshes Replaced Per Frame", &m_ChurnPerFrame, 0, 100);
+		ImGui::SliderInt("Defragment Moves Per Frame", &m_MovesPerFrame, 0, 64);
+		ImGui::Text("Meshes: %u, ranges moved last frame: %u", m_MeshPool->GetMeshCount(), m_MovedLastFrame);
+		ImGui::Text("Vertices: %u / %u used, %u free blocks", vertices.GetUsedSize(), vertices.GetCapacity(), vertices.GetFreeBlockCount());
+		ImGui::Text("Indices: %u / %u used, %u free blocks", indices.GetUsedSize(), indices.GetCapacity(), indices.GetFreeBlockCount());
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+
+	MeshPool::MeshHandle Test_MeshPool::AddRandomMesh()
+	{
+		static const int MaxSides = 12;
+		const int sides = 3 + rand() % (MaxSides - 2);
+
+		// Triangle fan around the center, texture coordinates follow the position
+		float vertices[(MaxSides + 1) * 4] = { 0.f, 0.f, 0.5f, 0.5f };
+		unsigned int indices[MaxSides * 3];
+		for (int i = 0; i < sides; ++i)
+		{
+			float angle = 6.2831853f * i / sides;
+			float x = 0.5f * std::cos(angle), y = 0.5f * std::sin(angle);
+			float* vertex = &vertices[(i + 1) * 4];
+			vertex[0] = x;
+			vertex[1] = y;
+			vertex[2] = x + 0.5f;
+			vertex[3] = y + 0.5f;
+
+			indices[i * 3 + 0] = 0;
+			indices[i * 3 + 1] = i + 1;
+			indices[i * 3 + 2] = (i + 1) % sides + 1;
+		}
+
+		return m_MeshPool->AddMesh(vertices, sides + 1, indices, sides * 3);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "MeshPool.h"
+#include "VertexBuffer.h"
+#include "IndirectBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_MeshPool : public Test
+	{
+	public:
+		Test_MeshPool();
+		~Test_MeshPool() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Add a regular polygon with a random number of sides to the pool. */
+		MeshPool::MeshHandle AddRandomMesh();
+
+	private:
+		static const int ObjectCount = 2500;
+
+		/** Every object's geometry lives in the pool, one object occupies one cell of the grid. */
+		std::unique_ptr<MeshPool> m_MeshPool;
+		/** Per-object model matrices, indexed by base instance. */
+		std::unique_ptr<VertexBuffer> m_ObjectVBO;
+		std::unique_ptr<IndirectBuffer> m_IndirectBuffer;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+
+		std::vector<MeshPool::MeshHandle> m_Objects;
+		std::vector<glm::mat4> m_ObjectTransforms;
+
+		glm::mat4 m_Proj, m_View;
+		/** Number of objects whose mesh is replaced every frame. */
+		int m_ChurnPerFrame;
+		int m_MovesPerFrame;
+		unsigned int m_MovedLastFrame;
+	};
+
+}
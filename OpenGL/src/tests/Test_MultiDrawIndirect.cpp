@@ -0,0 +1,127 @@
+#include "Test_MultiDrawIndirect.h"
+
+#include <cmath>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "VertexBufferLayout.h"
+#include "ResourceCache.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	Test_MultiDrawIndirect::Test_MultiDrawIndirect()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_ObjectCount(100)
+		, m_UploadedObjectCount(0)
+	{
+		// Two meshes in one vertex buffer: a unit quad followed by a triangle
+		float positions[] = {
+			-0.5f, -0.5f, 0.f,  0.f, // 0
+			 0.5f, -0.5f, 1.f,  0.f, // 1
+			 0.5f,  0.5f, 1.f,  1.f, // 2
+			-0.5f,  0.5f, 0.f,  1.f, // 3
+
+			-0.5f, -0.5f, 0.f,  0.f, // 0
+			 0.5f, -0.5f, 1.f,  0.f, // 1
+			 0.f,   0.5f, 0.5f, 1.f  // 2
+		};
+
+		// Indices are relative to the first vertex of each mesh, base vertex takes care of the rest
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0,
+
+			0, 1, 2
+		};
+
+		m_Meshes.push_back({ 6, 0, 0 });
+		m_Meshes.push_back({ 3, 6, 4 });
+
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_VAO.reset(new VertexArray());
+
+		m_VBO.reset(new VertexBuffer(positions, 7 * 4 * sizeof(float)));
+		VertexBufferLayout layout;
+		// Vertex position
+		layout.Push<float>(2);
+		// Texture coordinate
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+
+		m_ObjectVBO.reset(new VertexBuffer(MaxObjects * sizeof(glm::mat4), BufferUsage::Stream));
+		VertexBufferLayout objectLayout;
+		// Model matrix, fetched at gl_InstanceID + base instance
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		objectLayout.Push<float>(4, 1);
+		m_VAO->AddBuffer(*m_ObjectVBO, objectLayout);
+
+		m_IBO.reset(new IndexBuffer(indices, 9));
+
+		m_IndirectBuffer.reset(new IndirectBuffer());
+
+		m_Shader = ResourceCache::GetShader("res/shaders/Instanced.shader");
+		m_Shader->Bind();
+
+		m_Texture = ResourceCache::GetTexture("res/textures/Logo_Trans.png");
+		m_Texture->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		m_ObjectTransforms.reserve(MaxObjects);
+	}
+
+	void Test_MultiDrawIndirect::OnRender()
+	{
+		if (m_ObjectCount != m_UploadedObjectCount)
+		{
+			UpdateObjects();
+		}
+
+		Renderer renderer;
+
+		m_Texture->Bind();
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f("u_ViewProj", m_Proj * m_View);
+		renderer.MultiDrawIndirect(*m_VAO, *m_IBO, *m_Shader, *m_IndirectBuffer);
+	}
+
+	void Test_MultiDrawIndirect::OnImGuiRender()
+	{
+		ImGui::SliderInt("Object Count", &m_ObjectCount, 1, MaxObjects);
+		ImGui::Text("Draw commands: %u, submission: %s", m_IndirectBuffer->GetCount(), GLEW_VERSION_4_3 ? "glMultiDrawElementsIndirect" : "fallback loop");
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+
+	void Test_MultiDrawIndirect::UpdateObjects()
+	{
+		const int columns = (int)std::ceil(std::sqrt((float)m_ObjectCount));
+		const float cellSize = WINDOW_HEIGHT / columns;
+
+		m_ObjectTransforms.clear();
+		m_IndirectBuffer->Clear();
+		for (int i = 0; i < m_ObjectCount; ++i)
+		{
+			glm::vec3 position((i % columns + 0.5f) * cellSize, (i / columns + 0.5f) * cellSize, 0.f);
+			glm::mat4 model = glm::translate(glm::mat4(1.f), position);
+			model = glm::scale(model, glm::vec3(cellSize * 0.9f, cellSize * 0.9f, 1.f));
+			m_ObjectTransforms.push_back(model);
+
+			// One command per object, base instance selects its model matrix
+			const MeshRange& mesh = m_Meshes[i % m_Meshes.size()];
+			m_IndirectBuffer->AddDraw(mesh.IndexCount, mesh.FirstIndex, mesh.BaseVertex, i);
+		}
+
+		m_ObjectVBO->Orphan();
+		m_ObjectVBO->SetData(0, m_ObjectTransforms.data(), (unsigned int)(m_ObjectTransforms.size() * sizeof(glm::mat4)));
+		m_IndirectBuffer->Upload();
+		m_UploadedObjectCount = m_ObjectCount;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "IndirectBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_MultiDrawIndirect : public Test
+	{
+	public:
+		Test_MultiDrawIndirect();
+		~Test_MultiDrawIndirect() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Rebuild per-object transforms and draw commands for current object count. */
+		void UpdateObjects();
+
+	private:
+		struct MeshRange
+		{
+			unsigned int IndexCount;
+			unsigned int FirstIndex;
+			int BaseVertex;
+		};
+
+		static const int MaxObjects = 10000;
+
+		/** Vertices and indices of all meshes are packed into the same buffers. */
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		/** Per-object model matrices, indexed by base instance. */
+		std::unique_ptr<VertexBuffer> m_ObjectVBO;
+		std::unique_ptr<IndirectBuffer> m_IndirectBuffer;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+
+		std::vector<MeshRange> m_Meshes;
+		std::vector<glm::mat4> m_ObjectTransforms;
+
+		glm::mat4 m_Proj, m_View;
+		int m_ObjectCount;
+		int m_UploadedObjectCount;
+	};
+
+}
@@ -1,9 +1,11 @@
 #include "Test_Texture2D.h"
 
 #include "Renderer.h"
+#include "GLStateCache.h"
 #include "imgui/imgui.h"
 
 #include "VertexBufferLayout.h"
+#include "ResourceCache.h"
 
 namespace test
 {
@@ -12,6 +14,12 @@ namespace test
 		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
 		, m_TranslationA{ 200.f, 200.f, 0.f }
 		, m_TranslationB{ 400.f, 200.f, 0.f }
+		, m_bTint(false)
+		, m_bShaderTinted(false)
+		, m_bUseDDS(false)
+		, m_bTextureIsDDS(false)
+		, m_TextureMemorySize(0)
+		, m_bCompressedSupported(Texture::IsCompressedFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT))
 	{
 		// Two floats for vertex position and two floats for texture coordinate
 		// For texture coordinate system, the bottom-left is (0,0), the top-right is (1,1)
@@ -44,40 +52,90 @@ namespace test
 
 		m_IBO.reset(new IndexBuffer(indices, 6));
 
-		m_Shader.reset(new Shader("res/shaders/Basic.shader"));
-		m_Shader->Bind();
-		m_Shader->SetUniform4f("u_Color", 0.f, 1.f, 1.f, 1.f);
+		SelectTexture();
+		SelectShaderVariant();
 
-		m_Texture.reset(new Texture("res/textures/Logo_Trans.png"));
-		m_Texture->Bind();
-		m_Shader->SetUniform1i("u_Texture", 0);
+		m_FrameUniforms.reset(new UniformBuffer(FrameBlockLayout::GetSize()));
+	}
+
+	// Map z in the orthographic near(-1)/far(1) range to normalized distance from the camera
+	static float GetNormalizedDepth(const glm::vec3& translation)
+	{
+		return (1.f - translation.z) * 0.5f;
 	}
 
 	void Test_Texture2D::OnRender()
 	{
+		if (m_bTint != m_bShaderTinted)
+		{
+			SelectShaderVariant();
+		}
+		if (m_bUseDDS != m_bTextureIsDDS)
+		{
+			SelectTexture();
+		}
+
 		Renderer renderer;
 
+		unsigned char frameData[FrameBlockLayout::GetSize()];
+		FrameBlockLayout::Write<0>(frameData, m_Proj * m_View);
+		m_FrameUniforms->SetData(0, frameData, sizeof(frameData));
+		m_FrameUniforms->Bind(FrameBlockBinding);
+
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.f), m_TranslationA);
-			glm::mat4 mvp = m_Proj * m_View * model;
-
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+			m_RenderQueue.Submit(*m_VAO, *m_IBO, *m_Shader, m_Texture.get(), model, GetNormalizedDepth(m_TranslationA), 0, true);
 		}
 
 		{
 			glm::mat4 model = glm::translate(glm::mat4(1.f), m_TranslationB);
-			glm::mat4 mvp = m_Proj * m_View * model;
-
-			m_Shader->SetUniformMat4f("u_MVP", mvp);
-			renderer.Draw(*m_VAO, *m_IBO, *m_Shader);
+			m_RenderQueue.Submit(*m_VAO, *m_IBO, *m_Shader, m_Texture.get(), model, GetNormalizedDepth(m_TranslationB), 0, true);
 		}
+
+		// The logo is translucent, so the two quads are drawn back-to-front
+		m_RenderQueue.Flush(renderer);
 	}
 
 	void Test_Texture2D::OnImGuiRender()
 	{
 		ImGui::SliderFloat3("TranslationA", &m_TranslationA.x, 0.f, WINDOW_WIDTH);
 		ImGui::SliderFloat3("TranslationB", &m_TranslationB.x, 0.f, WINDOW_WIDTH);
+		ImGui::Checkbox("Tint(USE_TINT shader variant)", &m_bTint);
+		ImGui::Checkbox("Block-compressed(Logo_Trans.dds, BC3)", &m_bUseDDS);
+		if (m_bUseDDS && !m_bCompressedSupported)
+		{
+			ImGui::Text("BC3 is not supported by the driver!");
+		}
+		ImGui::Text("Texture VRAM: %.1f KB", m_TextureMemorySize / 1024.f);
+		const ResourceCache::Statistics& cacheStats = ResourceCache::GetStats();
+		ImGui::Text("Shaders alive: %u, cache hits: %u, revivals: %u, loads: %u", ResourceCache::GetShaderCount(), cacheStats.Hits, cacheStats.Revivals, cacheStats.Loads);
+		const GLStateCache::Statistics& stateStats = GLStateCache::GetStats();
+		ImGui::Text("GL bind calls issued: %u, skipped: %u", stateStats.IssuedCalls, stateStats.SkippedCalls);
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 	}
+
+	void Test_Texture2D::SelectTexture()
+	{
+		// The DDS carries its own mip chain, the PNG gets one from the driver
+		m_Texture = ResourceCache::GetTexture(m_bUseDDS ? "res/textures/Logo_Trans.dds" : "res/textures/Logo_Trans.png");
+		m_Texture->Bind();
+		m_bTextureIsDDS = m_bUseDDS;
+		m_TextureMemorySize = m_Texture->GetMemorySize();
+	}
+
+	void Test_Texture2D::SelectShaderVariant()
+	{
+		std::vector<std::string> defines;
+		if (m_bTint)
+		{
+			defines.push_back("USE_TINT");
+		}
+		m_Shader = ResourceCache::GetShader("res/shaders/Basic.shader", defines);
+		m_bShaderTinted = m_bTint;
+
+		// Uniform values belong to the program, a variant which has just been built starts with defaults
+		m_Shader->Bind();
+		m_Shader->SetUniform4f("u_Color", 0.f, 1.f, 1.f, 1.f);
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
 }
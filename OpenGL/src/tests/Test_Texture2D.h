@@ -9,6 +9,8 @@
 #include "IndexBuffer.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "RenderQueue.h"
+#include "UniformBuffer.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -24,15 +26,34 @@ namespace test
 		virtual void OnRender() override;
 		virtual void OnImGuiRender() override;
 
+	private:
+		/** Fetch the PNG or the DDS logo, whichever m_bUseDDS asks for. */
+		void SelectTexture();
+		/** Fetch the variant of Basic.shader matching the tint option, variants are shared through ResourceCache. */
+		void SelectShaderVariant();
+
 	private:
 		std::unique_ptr<VertexArray> m_VAO;
 		std::unique_ptr<VertexBuffer> m_VBO;
 		std::unique_ptr<IndexBuffer> m_IBO;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture;
+		/** Camera matrices, bound to FrameBlockBinding once per frame. */
+		std::unique_ptr<UniformBuffer> m_FrameUniforms;
+
+		RenderQueue m_RenderQueue;
 
 		glm::mat4 m_Proj, m_View;
 		glm::vec3 m_TranslationA, m_TranslationB;
+		bool m_bTint;
+		/** Whether m_Shader is currently the USE_TINT variant, the switch happens on the GL thread in OnRender(). */
+		bool m_bShaderTinted;
+		/** Show the BC3 block-compressed copy of the logo made by TextureCompressor instead of the PNG. */
+		bool m_bUseDDS;
+		bool m_bTextureIsDDS;
+		/** Copied from m_Texture in OnRender(), which may replace it while the UI runs on another thread. */
+		unsigned int m_TextureMemorySize;
+		bool m_bCompressedSupported;
 	};
 
 }
@@ -0,0 +1,92 @@
+#include "Test_TextureArray.h"
+
+#include <random>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	// Checker of two random colors with random cell sizes, so every tile is a distinct image of the same size
+	static std::vector<unsigned char> GenerateTile(std::mt19937& random, int size)
+	{
+		std::uniform_int_distribution<int> channels(32, 255);
+		std::uniform_int_distribution<int> periods(2, 8);
+		const glm::vec3 colorA(channels(random), channels(random), channels(random));
+		const glm::vec3 colorB(channels(random), channels(random), channels(random));
+		const int periodX = periods(random), periodY = periods(random);
+
+		std::vector<unsigned char> pixels(size * size * 4);
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const bool bA = ((x / periodX) + (y / periodY)) % 2 == 0;
+				const glm::vec3 color = bA ? colorA : colorB;
+				unsigned char* pixel = &pixels[(y * size + x) * 4];
+				pixel[0] = (unsigned char)color.r;
+				pixel[1] = (unsigned char)color.g;
+				pixel[2] = (unsigned char)color.b;
+				pixel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+
+	Test_TextureArray::Test_TextureArray()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_bUseArray(true)
+	{
+		m_Renderer2D.reset(new Renderer2D());
+		m_TextureArray.reset(new TextureArray(TileSize, TileSize, TileCount));
+
+		std::mt19937 random(7);
+		for (int i = 0; i < TileCount; ++i)
+		{
+			const std::vector<unsigned char> pixels = GenerateTile(random, TileSize);
+			m_TextureArray->Add(pixels.data());
+			m_Textures.emplace_back(new Texture(pixels.data(), TileSize, TileSize));
+		}
+		m_TextureArray->GenerateMipmaps();
+	}
+
+	void Test_TextureArray::OnRender()
+	{
+		m_Renderer2D->ResetStats();
+		m_Renderer2D->BeginBatch(m_Proj * m_View);
+
+		const unsigned int tileCount = m_TextureArray->GetLayerCount();
+		const glm::vec2 quadSize(WINDOW_WIDTH / GridSize, WINDOW_HEIGHT / GridSize);
+		for (int y = 0; y < GridSize; ++y)
+		{
+			for (int x = 0; x < GridSize; ++x)
+			{
+				// Scatter the tiles, neighbouring quads rarely share one
+				const unsigned int tile = (unsigned int)(x * 7 + y * 13) % tileCount;
+				glm::vec3 position((x + 0.5f) * quadSize.x, (y + 0.5f) * quadSize.y, 0.f);
+				if (m_bUseArray)
+				{
+					m_Renderer2D->DrawQuad(position, quadSize, *m_TextureArray, tile);
+				}
+				else
+				{
+					m_Renderer2D->DrawQuad(position, quadSize, *m_Textures[tile]);
+				}
+			}
+		}
+
+		m_Renderer2D->EndBatch();
+	}
+
+	void Test_TextureArray::OnImGuiRender()
+	{
+		ImGui::Checkbox("Use Texture Array", &m_bUseArray);
+		ImGui::Text("Tiles: %u of %dx%d, array limit %u layers", m_TextureArray->GetLayerCount(), TileSize, TileSize, TextureArray::GetMaxLayers());
+		const Renderer2D::Statistics& stats = m_Renderer2D->GetStats();
+		ImGui::Text("Quads: %u, Draw Calls: %u", stats.QuadCount, stats.DrawCalls);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "Renderer2D.h"
+#include "Texture.h"
+#include "TextureArray.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_TextureArray : public Test
+	{
+	public:
+		Test_TextureArray();
+		~Test_TextureArray() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		static const int TileCount = 256;
+		static const int TileSize = 32;
+		static const int GridSize = 40;
+
+		std::unique_ptr<Renderer2D> m_Renderer2D;
+		/** Every tile is a layer in here, and a texture of its own to compare against. */
+		std::unique_ptr<TextureArray> m_TextureArray;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+
+		glm::mat4 m_Proj, m_View;
+		bool m_bUseArray;
+	};
+
+}
@@ -0,0 +1,111 @@
+#include "Test_TextureAtlas.h"
+
+#include <random>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	// Disc with a random size and color on a transparent background, so every sprite is a distinct image
+	static std::vector<unsigned char> GenerateSprite(std::mt19937& random, int& size)
+	{
+		std::uniform_int_distribution<int> sizes(12, 64);
+		std::uniform_int_distribution<int> channels(64, 255);
+		size = sizes(random);
+		const unsigned char color[3] = { (unsigned char)channels(random), (unsigned char)channels(random), (unsigned char)channels(random) };
+
+		std::vector<unsigned char> pixels(size * size * 4);
+		const float radius = size * 0.5f;
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const glm::vec2 offset(x + 0.5f - radius, y + 0.5f - radius);
+				const float distance = glm::length(offset) / radius;
+				unsigned char* pixel = &pixels[(y * size + x) * 4];
+				for (int c = 0; c < 3; ++c)
+				{
+					pixel[c] = (unsigned char)(color[c] * (1.f - 0.5f * distance * distance));
+				}
+				pixel[3] = distance <= 1.f ? 255 : 0;
+			}
+		}
+		return pixels;
+	}
+
+	Test_TextureAtlas::Test_TextureAtlas()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_View(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 0.f)))
+		, m_bUseAtlas(true)
+		, m_PageToShow(-1)
+	{
+		GLCALL(glEnable(GL_BLEND));
+		// Set this to blend transparency properly
+		GLCALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+		m_Renderer2D.reset(new Renderer2D());
+		m_Atlas.reset(new TextureAtlas(1024));
+
+		TextureOptions options;
+		options.Mipmaps = MipmapMode::None;
+
+		std::mt19937 random(42);
+		for (int i = 0; i < GridSize * GridSize; ++i)
+		{
+			int size;
+			const std::vector<unsigned char> pixels = GenerateSprite(random, size);
+			m_Regions.push_back(m_Atlas->Add(pixels.data(), size, size));
+			m_Textures.emplace_back(new Texture(pixels.data(), size, size, options));
+		}
+		m_Atlas->Build();
+	}
+
+	void Test_TextureAtlas::OnRender()
+	{
+		m_Renderer2D->ResetStats();
+		m_Renderer2D->BeginBatch(m_Proj * m_View);
+
+		if (m_PageToShow >= 0)
+		{
+			const Texture& page = m_Atlas->GetPage(m_PageToShow);
+			const float scale = WINDOW_HEIGHT / page.GetHeight();
+			m_Renderer2D->DrawQuad(glm::vec3(WINDOW_WIDTH * 0.5f, WINDOW_HEIGHT * 0.5f, 0.f), glm::vec2(page.GetWidth() * scale, WINDOW_HEIGHT), page);
+		}
+		else
+		{
+			const glm::vec2 quadSize(WINDOW_WIDTH / GridSize, WINDOW_HEIGHT / GridSize);
+			for (int y = 0; y < GridSize; ++y)
+			{
+				for (int x = 0; x < GridSize; ++x)
+				{
+					const int index = y * GridSize + x;
+					glm::vec3 position((x + 0.5f) * quadSize.x, (y + 0.5f) * quadSize.y, 0.f);
+					// Without the atlas a batch ends every MaxTextureSlots sprites
+					if (m_bUseAtlas)
+					{
+						m_Renderer2D->DrawQuad(position, quadSize, m_Atlas->GetRegion(m_Regions[index]));
+					}
+					else
+					{
+						m_Renderer2D->DrawQuad(position, quadSize, *m_Textures[index]);
+					}
+				}
+			}
+		}
+
+		m_Renderer2D->EndBatch();
+	}
+
+	void Test_TextureAtlas::OnImGuiRender()
+	{
+		ImGui::Checkbox("Use Atlas", &m_bUseAtlas);
+		ImGui::SliderInt("Show Page", &m_PageToShow, -1, (int)m_Atlas->GetPageCount() - 1, m_PageToShow < 0 ? "Sprites" : "%d");
+		ImGui::Text("Sprites: %d, atlas pages: %u", GridSize * GridSize, m_Atlas->GetPageCount());
+		const Renderer2D::Statistics& stats = m_Renderer2D->GetStats();
+		ImGui::Text("Quads: %u, Draw Calls: %u", stats.QuadCount, stats.DrawCalls);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <vector>
+
+#include "Renderer2D.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_TextureAtlas : public Test
+	{
+	public:
+		Test_TextureAtlas();
+		~Test_TextureAtlas() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		static const int GridSize = 48;
+
+		std::unique_ptr<Renderer2D> m_Renderer2D;
+		/** Every sprite is in here once, and once more as a texture of its own to compare against. */
+		std::unique_ptr<TextureAtlas> m_Atlas;
+		std::vector<int> m_Regions;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+
+		glm::mat4 m_Proj, m_View;
+		bool m_bUseAtlas;
+		int m_PageToShow;
+	};
+
+}
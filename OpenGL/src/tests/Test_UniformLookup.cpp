@@ -0,0 +1,83 @@
+#include "Test_UniformLookup.h"
+
+#include <chrono>
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+namespace test
+{
+	static const char* const s_MethodNames[] = { "std::string map", "String literal", "constexpr UniformName", "UniformHandle" };
+
+	Test_UniformLookup::Test_UniformLookup()
+		: m_CallCount(100000)
+		, m_Times{}
+	{
+		m_Shader.reset(new Shader("res/shaders/Basic.shader"));
+		m_Shader->Bind();
+		m_TextureUniform = m_Shader->GetUniformHandle("u_Texture");
+		m_StringLocationCache["u_Texture"] = m_TextureUniform.Location;
+	}
+
+	void Test_UniformLookup::OnRender()
+	{
+		m_Shader->Bind();
+		for (int method = 0; method < Method_Count; ++method)
+		{
+			m_Times[method] = m_Times[method] * 0.9f + Run((Method)method) * 0.1f;
+		}
+	}
+
+	void Test_UniformLookup::OnImGuiRender()
+	{
+		ImGui::SliderInt("Calls Per Method", &m_CallCount, 1000, 1000000);
+		for (int method = 0; method < Method_Count; ++method)
+		{
+			ImGui::Text("%-24s %8.3f ms, %6.1f ns/call", s_MethodNames[method], m_Times[method], m_Times[method] * 1000000.f / m_CallCount);
+		}
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+
+	float Test_UniformLookup::Run(Method method)
+	{
+		static constexpr UniformName s_TextureName("u_Texture");
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+		switch (method)
+		{
+		case Method_StringMap:
+			for (int i = 0; i < m_CallCount; ++i)
+			{
+				const std::string name = "u_Texture";
+				int location = -1;
+				if (m_StringLocationCache.find(name) != m_StringLocationCache.end())
+				{
+					location = m_StringLocationCache[name];
+				}
+				GLCALL(glUniform1i(location, 0));
+			}
+			break;
+		case Method_Literal:
+			for (int i = 0; i < m_CallCount; ++i)
+			{
+				m_Shader->SetUniform1i("u_Texture", 0);
+			}
+			break;
+		case Method_PrehashedName:
+			for (int i = 0; i < m_CallCount; ++i)
+			{
+				m_Shader->SetUniform1i(s_TextureName, 0);
+			}
+			break;
+		case Method_Handle:
+			for (int i = 0; i < m_CallCount; ++i)
+			{
+				m_Shader->SetUniform1i(m_TextureUniform, 0);
+			}
+			break;
+		default:
+			break;
+		}
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Test.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Shader.h"
+
+namespace test
+{
+	/** Microbenchmark of the ways of setting a uniform, every method issues the same GL call so the differences come from the lookup. */
+	class Test_UniformLookup : public Test
+	{
+	public:
+		Test_UniformLookup();
+		~Test_UniformLookup() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		enum Method
+		{
+			/** What Shader used to do: build a std::string, then find() and operator[] in a string keyed map. */
+			Method_StringMap,
+			/** String literal, hashed at the call site. */
+			Method_Literal,
+			/** constexpr UniformName, hashed at compile time. */
+			Method_PrehashedName,
+			/** Pre-resolved UniformHandle, no lookup at all. */
+			Method_Handle,
+			Method_Count
+		};
+
+		/** Run m_CallCount uniform updates with one method and return the elapsed milliseconds. */
+		float Run(Method method);
+
+	private:
+		std::unique_ptr<Shader> m_Shader;
+		UniformHandle m_TextureUniform;
+		/** Replica of the former string keyed location cache. */
+		std::unordered_map<std::string, int> m_StringLocationCache;
+
+		int m_CallCount;
+		/** Smoothed over frames so that the numbers are readable. */
+		float m_Times[Method_Count];
+	};
+
+}
@@ -0,0 +1,166 @@
+#include "Test_VirtualTexture.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Renderer.h"
+#include "ResourceCache.h"
+#include "VertexBufferLayout.h"
+#include "VirtualTextureFile.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace test
+{
+	static const char* const s_PageFilePath = "VirtualTextureDemo.vtex";
+
+	void Test_VirtualTexture::BuildDemoPageFile(const char* filePath)
+	{
+		// Coarse gradient, rings and two grids, so every level has something to show
+		std::vector<unsigned char> pixels((size_t)ImageSize * ImageSize * 4);
+		for (int y = 0; y < ImageSize; ++y)
+		{
+			for (int x = 0; x < ImageSize; ++x)
+			{
+				unsigned char* pixel = &pixels[((size_t)y * ImageSize + x) * 4];
+				const float distance = std::sqrt((float)((x - ImageSize / 2) * (x - ImageSize / 2) + (y - ImageSize / 2) * (y - ImageSize / 2)));
+				pixel[0] = (unsigned char)(x * 255 / ImageSize);
+				pixel[1] = (unsigned char)(y * 255 / ImageSize);
+				pixel[2] = (unsigned char)(128.f + 127.f * std::sin(distance * 0.05f));
+				pixel[3] = 255;
+				if (x % 256 < 4 || y % 256 < 4)
+				{
+					pixel[0] = pixel[1] = pixel[2] = 255;
+				}
+				else if (x % 32 == 0 || y % 32 == 0)
+				{
+					pixel[0] /= 4;
+					pixel[1] /= 4;
+					pixel[2] /= 4;
+				}
+			}
+		}
+		VirtualTextureFile::Build(pixels.data(), ImageSize, ImageSize, filePath);
+	}
+
+	Test_VirtualTexture::Test_VirtualTexture()
+		: m_Proj(glm::ortho(0.f, WINDOW_WIDTH, 0.f, WINDOW_HEIGHT, -1.f, 1.f))
+		, m_ZoomLog2(-3.f)
+		, m_Center(0.5f, 0.5f)
+		, m_bShowLevels(false)
+		, m_CreationTime(std::chrono::high_resolution_clock::now())
+	{
+		// Unit quad, scaled to the image size by the model matrix
+		float positions[] = {
+			-0.5f, -0.5f, 0.f, 0.f, // 0
+			 0.5f, -0.5f, 1.f, 0.f, // 1
+			 0.5f,  0.5f, 1.f, 1.f, // 2
+			-0.5f,  0.5f, 0.f, 1.f  // 3
+		};
+
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		m_VAO.reset(new VertexArray());
+		m_VBO.reset(new VertexBuffer(positions, 4 * 4 * sizeof(float)));
+		VertexBufferLayout layout;
+		// Vertex position
+		layout.Push<float>(2);
+		// Texture coordinate
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VBO, layout);
+		m_IBO.reset(new IndexBuffer(indices, 6));
+
+		m_VirtualTexture.reset(new VirtualTexture(s_PageFilePath, CacheSize));
+		// Missing, truncated or written by an older version
+		if (!m_VirtualTexture->IsValid())
+		{
+			m_VirtualTexture.reset();
+			BuildDemoPageFile(s_PageFilePath);
+			m_VirtualTexture.reset(new VirtualTexture(s_PageFilePath, CacheSize));
+		}
+
+		// Submitted back to back, the driver compiles them on its own threads while the page file is streamed
+		m_Shaders[Main] = ResourceCache::GetShader("res/shaders/VirtualTexture.shader", {}, true);
+		m_Shaders[ShowLevels] = ResourceCache::GetShader("res/shaders/VirtualTexture.shader", { "SHOW_LEVELS" }, true);
+		m_Shaders[Feedback] = ResourceCache::GetShader("res/shaders/VirtualTexture.shader", { "FEEDBACK" }, true);
+		for (float& time : m_ShaderReadyTimes)
+		{
+			time = -1.f;
+		}
+	}
+
+	void Test_VirtualTexture::OnRender()
+	{
+		for (int i = 0; i < VariantCount; ++i)
+		{
+			if (m_ShaderReadyTimes[i] < 0.f && m_Shaders[i]->IsReady())
+			{
+				m_ShaderReadyTimes[i] = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_CreationTime).count();
+			}
+		}
+
+		m_VirtualTexture->Update();
+
+		const float zoom = std::exp2(m_ZoomLog2);
+		const glm::vec2 size(m_VirtualTexture->GetWidth() * zoom, m_VirtualTexture->GetHeight() * zoom);
+		const glm::vec2 position = glm::vec2(WINDOW_WIDTH, WINDOW_HEIGHT) * 0.5f - (m_Center - 0.5f) * size;
+		const glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(position, 0.f)), glm::vec3(size, 1.f));
+		const glm::mat4 mvp = m_Proj * model;
+
+		Renderer renderer;
+
+		// Same geometry drawn twice, first recording which pages it needs. Setting uniforms would wait for a pending build, so passes are skipped until then
+		Shader& feedbackShader = *m_Shaders[Feedback];
+		if (m_ShaderReadyTimes[Feedback] >= 0.f)
+		{
+			feedbackShader.Bind();
+			feedbackShader.SetUniformMat4f("u_MVP", mvp);
+			m_VirtualTexture->BeginFeedback(feedbackShader);
+			renderer.Draw(*m_VAO, *m_IBO, feedbackShader);
+			m_VirtualTexture->EndFeedback();
+		}
+
+		const ShaderVariant variant = m_bShowLevels ? ShowLevels : Main;
+		Shader& shader = *m_Shaders[variant];
+		if (m_ShaderReadyTimes[variant] >= 0.f)
+		{
+			shader.Bind();
+			shader.SetUniformMat4f("u_MVP", mvp);
+			m_VirtualTexture->Bind(shader);
+			renderer.Draw(*m_VAO, *m_IBO, shader);
+		}
+	}
+
+	void Test_VirtualTexture::OnImGuiRender()
+	{
+		ImGui::SliderFloat("Zoom(log2)", &m_ZoomLog2, -4.f, 3.f);
+		ImGui::SliderFloat2("Center", &m_Center.x, 0.f, 1.f);
+		ImGui::Checkbox("Tint Levels", &m_bShowLevels);
+
+		static const char* const s_VariantNames[VariantCount] = { "Main", "SHOW_LEVELS", "FEEDBACK" };
+		for (int i = 0; i < VariantCount; ++i)
+		{
+			if (m_ShaderReadyTimes[i] < 0.f)
+			{
+				ImGui::Text("Shader %s: compiling", s_VariantNames[i]);
+			}
+			else
+			{
+				ImGui::Text("Shader %s: ready after %.1f ms", s_VariantNames[i], m_ShaderReadyTimes[i]);
+			}
+		}
+
+		const unsigned int cacheSize = m_VirtualTexture->GetCacheTextureSize();
+		ImGui::Text("Image: %dx%d, %u levels", m_VirtualTexture->GetWidth(), m_VirtualTexture->GetHeight(), m_VirtualTexture->GetLevelCount());
+		ImGui::Text("Page cache: %ux%u, %.1f MB", cacheSize, cacheSize, cacheSize * cacheSize * 4 / (1024.f * 1024.f));
+		const VirtualTexture::Statistics& stats = m_VirtualTexture->GetStats();
+		ImGui::Text("Pages visible: %u, resident: %u/%u, pending: %u", stats.VisiblePages, stats.ResidentPages, CacheSize * CacheSize, stats.PendingPages);
+		ImGui::Text("Pages uploaded: %u, evicted: %u", stats.UploadedPages, stats.EvictedPages);
+		ImGui::Text("Lod bias: %.2f", stats.LodBias);
+		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+	}
+}
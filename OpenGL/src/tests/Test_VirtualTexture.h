@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Test.h"
+
+#include <chrono>
+#include <memory>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "VirtualTexture.h"
+
+#include "glm/glm.hpp"
+
+namespace test
+{
+	class Test_VirtualTexture : public Test
+	{
+	public:
+		Test_VirtualTexture();
+		~Test_VirtualTexture() {}
+
+		virtual void OnRender() override;
+		virtual void OnImGuiRender() override;
+
+	private:
+		/** Write the page file of a procedural image, only done the first time the test is opened. */
+		static void BuildDemoPageFile(const char* filePath);
+
+	private:
+		static const int ImageSize = 4096;
+		/** Pages across the cache, far fewer than the image has, so zooming and panning around keeps evicting. */
+		static const unsigned int CacheSize = 8;
+
+		std::unique_ptr<VertexArray> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VBO;
+		std::unique_ptr<IndexBuffer> m_IBO;
+		/** Variants of the same file, built asynchronously and in parallel. */
+		enum ShaderVariant { Main, ShowLevels, Feedback, VariantCount };
+		std::shared_ptr<Shader> m_Shaders[VariantCount];
+		/** Milliseconds from creation until each variant was ready, negative while pending. Sampled in OnRender(), IsReady() is a GL call. */
+		float m_ShaderReadyTimes[VariantCount];
+		std::unique_ptr<VirtualTexture> m_VirtualTexture;
+
+		glm::mat4 m_Proj;
+		/** Screen pixels per image pixel, as log2 so the slider feels even. */
+		float m_ZoomLog2;
+		/** Image point at the window center, in texture coordinates. */
+		glm::vec2 m_Center;
+		bool m_bShowLevels;
+		/** Start of the shader builds, for m_ShaderReadyTimes. */
+		std::chrono::high_resolution_clock::time_point m_CreationTime;
+	};
+
+}
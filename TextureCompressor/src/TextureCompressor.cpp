@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <GL/glew.h>
+
+#include "BlockCompressor.h"
+#include "DDSFile.h"
+#include "VirtualTextureFile.h"
+
+#include "stb_image/stb_image.h"
+
+static bool EndsWith(const std::string& text, const char* suffix)
+{
+	const size_t length = strlen(suffix);
+	return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+/**
+ * Offline converter from PNG(or anything else stb_image reads) to block-compressed DDS, or to the page file of a VirtualTexture.
+ * Usage: TextureCompressor <input> <output.dds> [bc1|bc3] [--no-mipmaps]
+ *        TextureCompressor <input> <output.vtex>
+ * Without a format, images with any transparent pixel become BC3 and all others BC1.
+ */
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "Usage: TextureCompressor <input> <output.dds> [bc1|bc3] [--no-mipmaps]" << std::endl;
+		std::cout << "       TextureCompressor <input> <output.vtex>" << std::endl;
+		return 1;
+	}
+
+	unsigned int format = 0;
+	bool bMipmaps = true;
+	for (int i = 3; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "bc1") == 0)
+		{
+			format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		}
+		else if (strcmp(argv[i], "bc3") == 0)
+		{
+			format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if (strcmp(argv[i], "--no-mipmaps") == 0)
+		{
+			bMipmaps = false;
+		}
+		else
+		{
+			std::cout << "Unknown option '" << argv[i] << "'!" << std::endl;
+			return 1;
+		}
+	}
+
+	// Same orientation as Texture uses for PNGs, so both load the same way up
+	stbi_set_flip_vertically_on_load(1);
+	int width, height, bpp;
+	unsigned char* pixels = stbi_load(argv[1], &width, &height, &bpp, 4/*RGBA*/);
+	if (!pixels)
+	{
+		std::cout << "Failed to load '" << argv[1] << "': " << stbi_failure_reason() << std::endl;
+		return 1;
+	}
+
+	if (EndsWith(argv[2], ".vtex"))
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		const bool bBuilt = VirtualTextureFile::Build(pixels, width, height, argv[2]);
+		const double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		stbi_image_free(pixels);
+		if (!bBuilt)
+		{
+			return 1;
+		}
+
+		std::cout << argv[1] << " -> " << argv[2] << ": " << width << "x" << height << " in pages of " << VirtualTextureFile::DefaultPageContent << "x" << VirtualTextureFile::DefaultPageContent
+			<< ", " << time << " ms" << std::endl;
+		return 0;
+	}
+
+	if (format == 0)
+	{
+		format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		for (int i = 0; i < width * height; ++i)
+		{
+			if (pixels[i * 4 + 3] != 255)
+			{
+				format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+				break;
+			}
+		}
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	const CompressedImage image = BlockCompressor::Compress(pixels, width, height, format, bMipmaps);
+	const double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	stbi_image_free(pixels);
+
+	if (!DDSFile::Save(argv[2], image))
+	{
+		return 1;
+	}
+
+	std::cout << argv[1] << " -> " << argv[2] << ": " << width << "x" << height << ", " << (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? "BC1" : "BC3")
+		<< ", " << image.Levels.size() << " levels, " << image.Data.size() << " bytes(" << width * height * 4 << " uncompressed), " << time << " ms" << std::endl;
+	return 0;
+}